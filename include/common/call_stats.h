@@ -0,0 +1,86 @@
+#ifndef CALL_STATS_H
+#define CALL_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Common {
+
+/**
+ * 单个接口的调用延迟直方图（HDR 风格的对数-线性分桶）
+ *
+ * 以微秒为单位，每个2的幂区间再线性分为 SUB_BUCKETS 份，相对误差约 1/SUB_BUCKETS，
+ * 覆盖 1us ~ 2^MAGNITUDES us（约67秒）。记录只做原子加，可在任意线程无锁调用。
+ */
+class CallHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAGNITUDES = 26;
+    static const int BUCKETS = (MAGNITUDES + 1) * SUB_BUCKETS;
+
+    struct Summary {
+        uint64_t count = 0;
+        uint64_t errors = 0;
+        double mean_us = 0.0;
+        double max_us = 0.0;
+        double p50_us = 0.0;
+        double p90_us = 0.0;
+        double p99_us = 0.0;
+        double p999_us = 0.0;
+    };
+
+    CallHistogram();
+
+    void record(std::chrono::steady_clock::duration elapsed, bool failed);
+    void reset();
+    Summary summary() const;
+
+private:
+    static int bucket_index(uint64_t us);
+    static double bucket_upper_us(int index);
+    double percentile(const std::array<uint64_t, BUCKETS> &counts, uint64_t total, double q) const;
+
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> errors_{0};
+    std::atomic<uint64_t> total_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+/**
+ * 进程内调用统计注册表：按接口名（如 "smc_pmove_unit"）保存直方图
+ *
+ * histogram() 返回的引用在进程生命周期内有效，调用点可缓存到静态变量，
+ * 之后记录无需查表加锁。
+ */
+class CallStatsRegistry {
+public:
+    static CallStatsRegistry &instance();
+
+    CallHistogram &histogram(const std::string &name);
+    void reset();
+    std::string to_json() const;      // {"name":{"count":..,"errors":..,"p50Us":..}, ...}
+    std::string to_table() const;     // 便于日志查看的文本表
+
+private:
+    CallStatsRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<CallHistogram>> histograms_;
+};
+
+// 返回值是否表示调用失败：short 型接口返回非0即错误码，其余（读取值的接口）不判定
+inline bool call_failed(short ret) { return ret != 0; }
+template <typename T>
+inline bool call_failed(const T &) { return false; }
+
+} // namespace Common
+
+#endif // CALL_STATS_H
@@ -5,6 +5,7 @@
 #include <array>
 #include <cmath>
 #include <string>
+#include <cstddef>
 
 namespace Common {
 
@@ -47,6 +48,41 @@ struct PlatformGeometry {
           H_target_upd(0), H_upd_up(0), H_up_down(0) {}
 };
 
+/**
+ * @brief 批量位姿只读视图（结构体数组SoA布局，便于编译器自动向量化）
+ * 各指针指向长度为 count 的连续数组，内存由调用方管理
+ */
+struct PoseBatchView {
+    const double* x;
+    const double* y;
+    const double* z;
+    const double* rx;     // 度
+    const double* ry;     // 度
+    const double* rz;     // 度
+    size_t count;
+};
+
+/**
+ * @brief 批量位姿（SoA布局），持有数据，可通过 view() 传给批量求解接口
+ */
+struct PoseBatch {
+    std::vector<double> x, y, z;       // 平移量 (mm)
+    std::vector<double> rx, ry, rz;    // 旋转量 (度)
+
+    void resize(size_t n) {
+        x.resize(n); y.resize(n); z.resize(n);
+        rx.resize(n); ry.resize(n); rz.resize(n);
+    }
+    size_t size() const { return x.size(); }
+    void set(size_t i, const Pose& p) {
+        x[i] = p.x; y[i] = p.y; z[i] = p.z;
+        rx[i] = p.rx; ry[i] = p.ry; rz[i] = p.rz;
+    }
+    PoseBatchView view() const {
+        return {x.data(), y.data(), z.data(), rx.data(), ry.data(), rz.data(), x.size()};
+    }
+};
+
 /**
  * @brief PVT轨迹点
  */
@@ -56,6 +92,76 @@ struct PVTPoint {
     double time;        // 时间 (s)
 };
 
+/**
+ * @brief 单轴运动约束（S曲线规划用）
+ */
+struct AxisMotionLimits {
+    double max_velocity;      // 最大速度 (mm/s)
+    double max_acceleration;  // 最大加速度 (mm/s²)
+    double max_jerk;          // 最大加加速度 (mm/s³)
+
+    AxisMotionLimits() : max_velocity(10.0), max_acceleration(50.0), max_jerk(500.0) {}
+    AxisMotionLimits(double v, double a, double j)
+        : max_velocity(v), max_acceleration(a), max_jerk(j) {}
+};
+
+/**
+ * @brief 6轴共用时间基准的PVT表，可直接组装为 setPvts 的 {time, pos, vel}
+ */
+struct SixAxisPVTTable {
+    std::vector<double> time;                       // 共用时间序列 (s)
+    std::array<std::vector<double>, 6> position;    // 各轴位置，相对起点 (mm)
+    std::array<std::vector<double>, 6> velocity;    // 各轴速度 (mm/s)
+
+    size_t size() const { return time.size(); }
+};
+
+class StewartPlatformKinematics;
+
+/**
+ * @brief 位姿样条：位置三次样条（C2，起止速度为0）+ 姿态四元数 SQUAD 插值
+ * 客户端只需提供少量关键帧，按任意密度采样后直接送入批量逆解。
+ * 姿态与 getRotationMatrix 一致（R = Rx*Ry*Rz，角度单位：度）。
+ */
+class PoseSpline {
+public:
+    /**
+     * @brief 构造样条
+     * @param keyframes 关键帧位姿（至少2个）
+     * @param times 关键帧时间 (s)，严格递增
+     * @return 参数有效时为 true
+     */
+    bool build(const std::vector<Pose>& keyframes, const std::vector<double>& times);
+
+    double startTime() const { return times_.empty() ? 0.0 : times_.front(); }
+    double endTime() const { return times_.empty() ? 0.0 : times_.back(); }
+
+    /**
+     * @brief 计算 t 时刻的位姿及位姿速度 [vx,vy,vz (mm/s), vrx,vry,vrz (度/s)]
+     */
+    void evaluate(double t, Pose& pose, std::array<double, 6>* pose_velocity = nullptr) const;
+
+    /**
+     * @brief 以固定间隔采样（含终点），直接写入SoA批量位姿
+     * @param interval 采样间隔 (s)
+     * @param batch 输出位姿
+     * @param times 输出采样时间（相对起点，从0开始）
+     * @param pose_velocities 可选，输出各采样点的位姿速度
+     */
+    void sample(double interval, PoseBatch& batch, std::vector<double>& times,
+                std::vector<std::array<double, 6>>* pose_velocities = nullptr) const;
+
+private:
+    std::vector<double> times_;
+    std::array<std::vector<double>, 3> position_;     // 关键帧 x,y,z
+    std::array<std::vector<double>, 3> second_deriv_; // 样条节点二阶导
+    std::vector<std::array<double, 4>> quat_;         // 关键帧四元数 (w,x,y,z)
+    std::vector<std::array<double, 4>> squad_ctrl_;   // SQUAD 中间控制四元数
+
+    void evaluateOrientation(double t, double& rx, double& ry, double& rz) const;
+    size_t segmentIndex(double t) const;
+};
+
 /**
  * @brief 轨迹规划器 - 余弦加减速PVT规划
  * 参考BGsystem的PVT_6Move函数实现
@@ -83,6 +189,93 @@ public:
                                         int speed_level,
                                         std::array<std::vector<PVTPoint>, 6>& trajectories);
 
+    static constexpr double DEFAULT_PVT_INTERVAL = 0.01;   // 默认PVT采样间隔 (s)
+
+    /**
+     * @brief 七段式S曲线（加加速度受限）最短时间
+     * @param displacement 位移量 (mm)
+     * @param limits 速度/加速度/加加速度约束
+     * @return 最短运动时间 (s)
+     */
+    static double sCurveMinimumTime(double displacement, const AxisMotionLimits& limits);
+
+    /**
+     * @brief 七段式S曲线（加加速度受限）最短时间规划
+     * 与 planCosineProfile 不同，运动时间由位移和约束决定，小位移的运动时间相应缩短。
+     * @param displacement 目标位移量 (mm)
+     * @param limits 速度/加速度/加加速度约束
+     * @param trajectory 输出轨迹点数组（起止速度为0，采样间隔不超过 sample_interval）
+     * @param sample_interval PVT采样间隔 (s)
+     * @return 规划的总时间 (s)
+     */
+    static double planSCurveProfile(double displacement, const AxisMotionLimits& limits,
+                                    std::vector<PVTPoint>& trajectory,
+                                    double sample_interval = DEFAULT_PVT_INTERVAL);
+
+    /**
+     * @brief 为6轴分别规划S曲线轨迹（各轴独立，按各自最短时间）
+     * @param displacements 6轴位移量
+     * @param limits 6轴约束
+     * @param trajectories 6轴轨迹输出
+     * @param sample_interval PVT采样间隔 (s)
+     * @return 最长的轴运动时间 (s)
+     */
+    static double planSixAxisSCurve(const std::array<double, 6>& displacements,
+                                    const std::array<AxisMotionLimits, 6>& limits,
+                                    std::array<std::vector<PVTPoint>, 6>& trajectories,
+                                    double sample_interval = DEFAULT_PVT_INTERVAL);
+
+    /**
+     * @brief 6轴时间同步的S曲线规划
+     * 所有轴共用一条归一化S曲线 s(t)∈[0,1]，第i轴位置为 d_i*s(t)，因此各轴同时起停、
+     * 腿长空间内走直线。归一化曲线的约束取 min_i(limit_i/|d_i|)，保证每条腿都不超出
+     * 自身的速度/加速度/加加速度约束，总时间等于受约束最紧的腿的最短时间。
+     * @param displacements 6轴位移量 (mm)
+     * @param limits 6轴约束
+     * @param table 输出共用时间基准的PVT表
+     * @param sample_interval PVT采样间隔 (s)
+     * @return 同步后的总时间 (s)
+     */
+    static double planSynchronizedSixAxis(const std::array<double, 6>& displacements,
+                                          const std::array<AxisMotionLimits, 6>& limits,
+                                          SixAxisPVTTable& table,
+                                          double sample_interval = DEFAULT_PVT_INTERVAL);
+
+    /**
+     * @brief 位姿路径的时间最优参数化（TOPP）
+     * 路径为相邻路点之间的位姿线性插值，经逆解映射到腿长空间后，在腿速度/加速度约束下
+     * 用前向/后向两遍积分求路径速度上限 ṡ(s)，得到最快可行的时间分配（不考虑加加速度）。
+     * 路点处方向突变时曲率大，会自动减速通过；起止速度为0。
+     * @param kinematics 运动学求解器
+     * @param waypoints 路点序列（至少2个，角度单位：度）
+     * @param limits 6条腿的速度/加速度约束
+     * @param table 输出PVT表（位置为相对第一个路点的腿长增量）
+     * @param sample_interval PVT输出点的最小时间间隔 (s)
+     * @param samples_per_segment 每段路径的离散点数
+     * @return 总时间 (s)；有路点不可达时返回 -1
+     */
+    static double planTimeOptimalPath(const StewartPlatformKinematics& kinematics,
+                                      const std::vector<Pose>& waypoints,
+                                      const std::array<AxisMotionLimits, 6>& limits,
+                                      SixAxisPVTTable& table,
+                                      double sample_interval = DEFAULT_PVT_INTERVAL,
+                                      int samples_per_segment = 100);
+
+    /**
+     * @brief PVT点精简（Douglas-Peucker，Hermite误差界）
+     * 控制器在相邻PVT点之间做三次Hermite插补；若删除某些点后，保留点之间的Hermite曲线
+     * 与原插补曲线的最大偏差（在原采样点及其区间中点处检查）不超过 tolerance，则删除这些点。
+     * 首末点始终保留。
+     * @param time 时间序列 (s)，严格递增
+     * @param pos 位置序列
+     * @param vel 速度序列
+     * @param count 点数
+     * @param tolerance 允许的位置偏差（与 pos 同单位）
+     * @return 保留点的下标（升序）
+     */
+    static std::vector<size_t> reducePVTPoints(const double* time, const double* pos, const double* vel,
+                                               size_t count, double tolerance);
+
     /**
      * @brief 将位移转换为脉冲数
      * @param displacement_mm 位移量 (mm)
@@ -116,7 +309,41 @@ public:
      * @return 是否在可达范围内
      */
     bool calculateInverseKinematics(const Pose& pose, std::array<double, 6>& leg_lengths);
-    
+
+    /**
+     * @brief 批量逆运动学（整条轨迹），不分配内存、不输出日志
+     * 每个位姿只计算一次旋转矩阵，腿长按块逐腿计算以便自动向量化。
+     * 与 calculateInverseKinematics 不同，超限的点不会中断计算，仍输出其腿长。
+     * @param poses 位姿序列（SoA）
+     * @param leg_lengths 输出腿长，长度至少 poses.count
+     * @param reachable 可选，输出每个点是否在腿长范围内（1/0），长度至少 poses.count
+     * @return 不可达点的数量
+     */
+    size_t calculateInverseKinematicsBatch(const PoseBatchView& poses,
+                                           std::array<double, 6>* leg_lengths,
+                                           unsigned char* reachable = nullptr) const;
+
+    /**
+     * @brief 腿长裕量：margin = min_i min(L_i - L_min, L_max - L_i) (mm)
+     * 大于0表示可达，数值即距离最近腿长限位的余量；无日志、无内存分配，可用于高频校验
+     * @param pose 位姿
+     * @return 腿长裕量 (mm)
+     */
+    double calculateLegMargin(const Pose& pose) const;
+
+    /**
+     * @brief 沿位姿方向的最大可行步长（二分搜索）
+     * 求最大的 s∈[0, max_step]，使 start + s*direction 同时满足腿长限位与Z轴投影约束
+     * （见 calculateZAxisDisplacement），用于点动前显示各方向剩余行程。
+     * @param start 起始位姿
+     * @param direction 方向 [x,y,z (mm), rx,ry,rz (度)]，不要求归一化
+     * @param max_step 搜索上限（direction 的倍数）
+     * @param tolerance 步长收敛精度
+     * @return 最大可行步长；起始位姿不可行时返回0
+     */
+    double calculateMaxTravel(const Pose& start, const std::array<double, 6>& direction,
+                              double max_step, double tolerance = 1e-4) const;
+
     /**
      * @brief 计算增量位移（相对于当前位置）
      * 参考BGsystem的Cal_s函数: m[i] = m[i] - pre_m[i]
@@ -136,7 +363,7 @@ public:
      * @param z_displacements 输出6个推杆的Z向位移（绝对值）
      * @return 是否在可达范围内
      */
-    bool calculateZAxisDisplacement(const Pose& pose, std::array<double, 6>& z_displacements);
+    bool calculateZAxisDisplacement(const Pose& pose, std::array<double, 6>& z_displacements) const;
     
     /**
      * @brief 将靶点pose转换为上平台铰点面pose（BGsystem兼容）
@@ -155,6 +382,49 @@ public:
      */
     bool calculateZAxisDisplacementFromTarget(const Pose& target_pose, std::array<double, 6>& z_displacements);
 
+    /**
+     * @brief 正运动学：由6条腿长求解位姿（Newton-Raphson迭代）
+     * 与 calculateInverseKinematics 互逆（相同的铰点几何与 initial_height）。
+     * 以 initial_guess 为迭代初值，连续调用时传入上一次的解（热启动）通常2~3次迭代即可收敛。
+     * @param leg_lengths 6条腿的绝对长度 (mm)
+     * @param initial_guess 迭代初值
+     * @param pose 输出位姿（角度单位：度）
+     * @param iterations 可选，输出实际迭代次数
+     * @return 是否收敛
+     */
+    bool calculateForwardKinematics(const std::array<double, 6>& leg_lengths,
+                                    const Pose& initial_guess, Pose& pose,
+                                    int* iterations = nullptr) const;
+
+    /**
+     * @brief 逆雅可比矩阵：位姿变化率 -> 腿长变化率，J[i][j] = dL_i/dpose_j
+     * 位姿分量顺序 x,y,z (mm), rx,ry,rz (度)，即 dL = J * dpose（欧拉角速率，非角速度矢量）
+     * @param pose 当前位姿
+     * @param J 输出 6x6 逆雅可比矩阵
+     */
+    void calculateInverseJacobian(const Pose& pose, std::array<std::array<double, 6>, 6>& J) const;
+
+    /**
+     * @brief 由位姿变化率计算6条腿的伸缩速度（解析解，无差分噪声）
+     * 姿态分量为欧拉角速率 d(rx,ry,rz)/dt，与位姿样条的采样速度一致；非零姿态下不等于角速度矢量，
+     * 角速度（twist）输入使用 calculateLegVelocitiesFromTwist
+     * @param pose 当前位姿
+     * @param pose_rate 位姿变化率 [vx,vy,vz (mm/s), drx,dry,drz (度/s)]
+     * @param leg_velocities 输出腿长速度 (mm/s)
+     */
+    void calculateLegVelocities(const Pose& pose, const std::array<double, 6>& pose_rate,
+                                std::array<double, 6>& leg_velocities) const;
+
+    /**
+     * @brief 由平台笛卡尔速度旋量（twist）计算6条腿的伸缩速度
+     * dL_i/dt = u_i · (v + ω × R·p_i)，u_i 为腿单位方向，R·p_i 为铰点相对平台中心的基座系矢量
+     * @param pose 当前位姿
+     * @param twist [vx,vy,vz (mm/s), ωx,ωy,ωz (度/s)]，角速度在基座坐标系下表示
+     * @param leg_velocities 输出腿长速度 (mm/s)
+     */
+    void calculateLegVelocitiesFromTwist(const Pose& pose, const std::array<double, 6>& twist,
+                                         std::array<double, 6>& leg_velocities) const;
+
     // Getters
     double getBaseRadius() const { return geometry_.base_radius; }
     double getPlatformRadius() const { return geometry_.platform_radius; }
@@ -183,11 +453,28 @@ private:
      */
     void initializeGeometry();
     
+    static constexpr size_t IK_BATCH_BLOCK = 64;     // 批量逆解分块大小（块内数据放在栈上）
+    static constexpr int FK_MAX_ITERATIONS = 20;     // 正解最大迭代次数
+    static constexpr double FK_TOLERANCE = 1e-6;     // 正解腿长残差收敛阈值 (mm)
+
     /**
      * @brief 计算旋转矩阵 (Z-Y-X欧拉角)
      */
     void getRotationMatrix(double rx, double ry, double rz, 
-                          std::array<std::array<double, 3>, 3>& R);
+                          std::array<std::array<double, 3>, 3>& R) const;
+
+    /**
+     * @brief 计算旋转矩阵对 rx/ry/rz 的偏导数（每度）
+     */
+    void getRotationMatrixDerivatives(double rx, double ry, double rz,
+                                      std::array<std::array<std::array<double, 3>, 3>, 3>& dR) const;
+
+    /**
+     * @brief 计算给定位姿下的腿长及其对位姿的雅可比矩阵 J[i][j] = dL_i/dpose_j
+     * 位姿分量顺序 x,y,z (mm), rx,ry,rz (度)；不做腿长限位检查
+     */
+    void calculateLegJacobian(const Pose& pose, std::array<double, 6>& leg_lengths,
+                              std::array<std::array<double, 6>, 6>& J) const;
     
     /**
      * @brief 计算标称连杆长度
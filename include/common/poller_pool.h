@@ -0,0 +1,53 @@
+#ifndef POLLER_POOL_H
+#define POLLER_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Common {
+
+/**
+ * 周期任务线程池：同一进程内多个设备共享少量线程执行各自的轮询周期
+ *
+ * 每个任务按自己的频率调度，同一任务不会并发执行；落后超过一个周期时不追赶。
+ * 工作线程按需增加，数量不超过 min(任务数, max_workers)。
+ */
+class PollerPool {
+public:
+    PollerPool(const std::string &name, size_t max_workers);
+    ~PollerPool();
+
+    long add(double rate_hz, std::function<void()> task);
+    void remove(long id);                 // 返回时该任务已不在执行
+    size_t workers() const;
+
+private:
+    struct Task {
+        std::chrono::steady_clock::duration period;
+        std::chrono::steady_clock::time_point next;
+        std::function<void()> fn;
+        bool running = false;
+        bool removed = false;
+    };
+
+    void worker_loop();
+
+    std::string name_;
+    size_t max_workers_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<long, Task> tasks_;
+    std::vector<std::thread> workers_;
+    long next_id_ = 1;
+    bool stop_ = false;
+};
+
+} // namespace Common
+
+#endif // POLLER_POOL_H
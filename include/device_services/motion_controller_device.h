@@ -8,6 +8,13 @@
 #include <mutex>
 #include <set>
 #include <chrono>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <condition_variable>
+#include <map>
+#include <list>
+#include <memory>
 
 namespace MotionController {
 
@@ -46,10 +53,51 @@ public:
     void moveRelative(const Tango::DevVarDoubleArray *argin);        // 相对运动 [axis_id, distance]
     void moveAbsolute(const Tango::DevVarDoubleArray *argin);        // 绝对运动 [axis_id, position]
     void stopMove(Tango::DevShort axis_id);                          // 停止
+    void moveRelativeMulti(const Tango::DevVarDoubleArray *argin);   // 多轴同步相对运动 [axis, dist, axis, dist, ...]
+    void moveAbsoluteMulti(const Tango::DevVarDoubleArray *argin);   // 多轴同步绝对运动 [axis, pos, axis, pos, ...]
     
     // PVTS motion commands
     void setPvts(Tango::DevString argin);                            // PVTS参数设置
     void movePvts(Tango::DevString argin);                           // PVTS运动
+    void setPvtsBinary(const Tango::DevVarDoubleArray *argin);       // PVTS参数设置（二进制，免JSON）
+    
+    // PVT streaming commands（经连续插补缓冲区分块下发长轨迹）
+    void pvtStreamOpen(Tango::DevString argin);                      // 打开流: {"axes":[...],"crd":0}
+    Tango::DevLong pvtStreamAppend(Tango::DevString argin);          // 追加分块 {"time","pos","vel"(可选),"last"}，返回主机侧剩余分块槽位
+    void pvtStreamStop();                                            // 中止流并停止插补
+    Tango::DevString pvtStreamStatus();                              // 流状态（JSON）
+    
+    // Conti path commands（连续插补路径：直线/圆弧段 + 前瞻 + 拐角平滑）
+    void contiOpen(Tango::DevString argin);                          // {"crd":1,"axes":[0,1],"lookahead":50,"blend":true}，crd 0 保留给多轴同步运动
+    Tango::DevLong contiAppend(Tango::DevString argin);              // 追加段，返回控制器剩余缓冲空间
+    void contiStart();                                               // 启动/暂停后继续
+    void contiPause();                                               // 暂停
+    void contiStop(Tango::DevShort stop_mode);                       // 停止并关闭列表（0=减速,1=立即）
+    void contiSetOverride(Tango::DevDouble percent);                 // 速度倍率（%）
+    Tango::DevString contiStatus();                                  // 路径状态（JSON）
+    
+    // Position compare (hcmp) commands（运动中按位置硬件触发输出）
+    void hcmpConfig(Tango::DevString argin);                         // {"hcmp":0,"axis":0,"mode":"queue","source":1,"logic":0,"pulseUs":1000}
+    void hcmpAddPoints(const Tango::DevVarDoubleArray *argin);       // [hcmp, pos1, pos2, ...]
+    void hcmpSetLinear(const Tango::DevVarDoubleArray *argin);       // [hcmp, start_pos, increment, count]
+    void hcmpClear(Tango::DevShort hcmp);                            // 清除比较点
+    Tango::DevVarDoubleArray *hcmpStatus(Tango::DevShort hcmp);      // [剩余点数, 当前比较位置, 已触发点数]
+    
+    // Position latch commands（外部信号触发时硬件锁存轴位置）
+    void latchArm(Tango::DevString argin);                           // {"latch":0,"axes":[0,1],"type":"ltc","mode":"multi","logic":0,"source":1}
+    Tango::DevVarDoubleArray *latchRead(Tango::DevShort latch);      // [轴数, 然后每轴: 轴号, 个数n, v1..vn]
+    
+    // Controller script commands（控制器端 BASIC/G代码程序，多步序列由控制器连续执行）
+    void scriptLoad(Tango::DevString argin);                         // {"template":"homeBackoffPark","params":{..}} 或 {"type":"gcode","text":".."}
+    void scriptStart();                                              // 启动/暂停后继续；运行期间状态为 MOVING，拒绝主机运动指令
+    void scriptPause();
+    void scriptStop();
+    Tango::DevString scriptStatus();                                 // {"type","name","state","line",...}
+    Tango::DevString scriptTemplates();                              // 模板库（内置 + scriptTemplates 属性）
+    
+    // Async command queue（异步命令队列，立即返回命令ID）
+    Tango::DevLong submitCommand(Tango::DevString argin);            // {"cmd":"moveAbsolute","args":[0,100]}
+    Tango::DevString commandStatus(Tango::DevLong command_id);       // 命令状态（JSON）
     
     // Parameter configuration commands (规范名称)
     void setMoveParameter(const Tango::DevVarDoubleArray *argin);    // 电机运动属性设置
@@ -61,6 +109,7 @@ public:
     Tango::DevBoolean readOrg(Tango::DevShort axis_id);              // 原点状态读取
     Tango::DevShort readEL(Tango::DevShort axis_id);                 // 限位状态读取
     Tango::DevDouble readPos(Tango::DevShort axis_id);               // 读取当前位置
+    Tango::DevVarDoubleArray *readAxesSnapshot(Tango::DevLong axis_mask);  // 批量轴状态（一次往返）
     
     // Encoder commands
     void setEncoderPosition(const Tango::DevVarDoubleArray *argin);  // 设置编码器位置 [axis_id, position]
@@ -75,6 +124,8 @@ public:
     void exportAxis();                                                // 轴参数导出
     void simSwitch(Tango::DevShort mode);                            // 模拟运行开关
     Tango::DevString errorParse(Tango::DevShort error_code);         // 错误码解析
+    void resetSmcCallStats();                                         // 清零SMC调用统计
+    Tango::DevString dumpSmcCallStats();                              // SMC调用统计（文本表，同时写日志）
     
     // Interlock interface - 联锁接口
     void setDisabled(bool disabled);                                  // 设置禁用状态（由联锁服务调用）
@@ -96,6 +147,10 @@ public:
     void read_specialLocationValue(Tango::Attribute &attr);
     void read_axisStatus(Tango::Attribute &attr);
     void read_resultValue(Tango::Attribute &attr);
+    void read_eventRate(Tango::Attribute &attr);
+    void read_commandQueue(Tango::Attribute &attr);
+    void read_smcCallStats(Tango::Attribute &attr);
+    void read_latchedPositions(Tango::Attribute &attr);
 
     virtual void always_executed_hook();
     virtual void read_attr_hardware(std::vector<long> &attr_list);
@@ -126,6 +181,9 @@ private:
     std::string struct_parameter_prop_;    // structParameter (JSON)
     std::string is_brake_;            // isBrake (JSON)
     std::string move_parameter_prop_; // moveParameter (JSON)
+    double pvt_reduce_tolerance_;     // pvtReduceTolerance: PVT点精简允许偏差（位置单位，<=0 不精简）
+    std::string event_deadbands_prop_; // eventDeadbands (JSON): {"motorPos":{"abs":0.001,"rel":0}, ...}
+    std::string script_templates_prop_; // scriptTemplates (JSON): {"name":{"type":"gcode","text":"..","defaults":{..}}}
     
     // ========== Attributes (规范Attribute) ==========
     Tango::DevLong self_check_result_;       // selfCheckResult
@@ -154,12 +212,16 @@ private:
     Tango::DevString attr_moveParameter_read;
     Tango::DevBoolean attr_axisStatus_read[MAX_AXES];
     Tango::DevShort attr_resultValue_read;
+    Tango::DevDouble attr_eventRate_read;
+    Tango::DevString attr_commandQueue_read;
+    Tango::DevString attr_smcCallStats_read;
+    Tango::DevString attr_latchedPositions_read;
     
     // ========== Hardware connection ==========
     std::string controller_ip_;
     int card_id_;
-    bool is_connected_;
-    bool sim_mode_;                          // 模拟运行模式
+    std::atomic<bool> is_connected_;
+    std::atomic<bool> sim_mode_;             // 模拟运行模式
     
     // Lock management
     bool is_locked_;
@@ -179,6 +241,158 @@ private:
     int health_check_interval_count_;        // 健康检查计数器
     static const int HEALTH_CHECK_INTERVAL = 100;  // 每100次hook调用检查一次连接健康
     
+    // ========== Background hardware poller ==========
+    // 进程内共享的轮询线程池按固定频率执行各设备的轮询周期，读取硬件状态并发布为不可变快照，
+    // 属性读取与状态机只读快照，不再在 CORBA 线程中逐轴调用 SMC 接口。
+    struct HardwareSnapshot {
+        bool valid = false;                              // 至少完成一次完整轮询
+        bool link_ok = true;                             // 最近一个周期所有带错误码的读取均成功
+        std::chrono::steady_clock::time_point stamp;
+        std::array<double, MAX_AXES> position{};
+        std::array<bool, MAX_AXES> done{};               // smc_check_done == 1
+        std::array<bool, MAX_AXES> el_pos{};             // 由 smc_axis_io_status 解出（0x01），限位用于刹车联锁
+        std::array<bool, MAX_AXES> el_neg{};             // 0x02
+        std::array<short, MAX_AXES> org{};               // 以下为慢速组，每 POLL_SLOW_DIVIDER 次刷新
+        std::array<short, MAX_AXES> servo_on{};
+        std::array<double, MAX_IO_CHANNELS> inputs{};
+        std::array<double, MAX_AD_CHANNELS> ain{};
+        int conti_crd = -1;                              // 采样的连续插补坐标系（conti_poll_crd_），-1 为未采样
+        short conti_run_state = -1;                      // smc_conti_get_run_state: 0=运行, 1=暂停, 2=停止
+        int script_kind = 0;                             // 采样的脚本类型（script_poll_kind_），0 为未采样
+        int script_state = -1;                           // smc_basic_state / smc_gcode_state，0=停止，-1 为未采样或读取失败
+    };
+    static const int POLL_SLOW_DIVIDER = 10;
+    std::shared_ptr<const HardwareSnapshot> snapshot_;  // 仅经 std::atomic_load/atomic_store 访问
+    std::atomic<uint64_t> snapshot_version_{0};      // 每发布一次快照加1
+    std::atomic<uint64_t> motion_snapshot_barrier_{0};  // 早于此版本的快照不用于判定运动完成
+    double poll_rate_hz_;                            // pollRateHz，默认 50
+    uint64_t poll_overruns_{0};                      // 周期耗时超过 1/pollRateHz 的次数
+    std::chrono::steady_clock::time_point poll_overrun_logged_;
+    long poll_task_id_{0};                           // 轮询线程池中的任务号，0 表示未注册
+    uint64_t poll_cycle_count_{0};
+    std::mutex hw_poll_mutex_;                       // 轮询周期与板卡打开/关闭互斥
+    void start_poller();
+    void stop_poller();
+    void poll_cycle();
+    bool read_snapshot(HardwareSnapshot &out) const;
+    void invalidate_snapshot();
+    void publish_snapshot(std::shared_ptr<const HardwareSnapshot> snap);
+    void note_motion_command();
+    
+    // ========== Change/archive events ==========
+    // 事件任务比较最新快照与上次推送值，超过死区才推送 change/archive 事件，
+    // 下游设备订阅事件即可，不必各自轮询 motorPos/axisStatus/IO。
+    struct EventDeadband {
+        double abs_change = 0.0;                     // 绝对死区（<=0 不启用）
+        double rel_change = 0.0;                     // 相对死区（比例，<=0 不启用）
+    };
+    std::map<std::string, EventDeadband> event_deadbands_;
+    long event_task_id_{0};
+    std::atomic<double> event_rate_{0.0};            // 最近1秒推送的事件数
+    uint64_t ev_last_version_{0};
+    bool ev_primed_{false};                          // 首个有效快照无条件推送一次
+    long ev_window_events_{0};
+    std::chrono::steady_clock::time_point ev_window_start_;
+    std::array<double, MAX_AXES> ev_motor_pos_{};    // 上次推送值
+    std::array<Tango::DevBoolean, MAX_AXES> ev_axis_status_{};
+    std::array<double, MAX_IO_CHANNELS> ev_io_{};
+    std::array<double, MAX_AXES> ev_special_{};
+    std::array<double, MAX_AD_CHANNELS> ev_ain_{};
+    void event_cycle();
+    bool exceeds_deadband(const std::string &attr_name, const double *last, const double *value, size_t n) const;
+    
+    // ========== Conti path ==========
+    bool conti_open_{false};
+    bool conti_closed_{false};                       // 已 close_list，不再接受新段
+    bool conti_started_{false};                      // 已 start_list；关闭且控制器报告停止后视为执行完毕
+    std::atomic<int> conti_poll_crd_{-1};            // 轮询周期采样运行状态的坐标系，-1 为不采样
+    unsigned short conti_crd_{1};
+    std::vector<unsigned short> conti_axes_;
+    long conti_segments_{0};                         // 已压入的段数（默认段标号）
+    
+    // ========== Position latch ==========
+    struct LatchConfig {
+        bool axis_latch = false;                     // true: smc_set_latch_mode 单轴锁存；false: smc_ltc_* 锁存通道
+        std::vector<unsigned short> axes;
+    };
+    std::map<int, LatchConfig> latch_configs_;       // 按锁存通道号
+    std::string latched_positions_json_;             // latchedPositions: 最近一次 latchRead 的结果
+    
+    // ========== Controller scripts ==========
+    struct ScriptTemplate {
+        std::string type;                            // "basic" / "gcode"
+        std::string text;                            // ${name} 为参数占位符
+        std::map<std::string, std::string> defaults;
+    };
+    std::map<std::string, ScriptTemplate> script_templates_;
+    std::string script_type_;                        // 已下载程序的类型，空表示未下载
+    std::string script_name_;                        // 控制器内文件名
+    bool script_running_{false};                     // 已启动且控制器尚未报告停止（含暂停），期间保持 MOVING
+    bool script_paused_{false};
+    std::atomic<int> script_poll_kind_{0};           // 轮询周期采样的脚本类型：0=不采样, 1=BASIC, 2=G代码
+    std::string script_messages_;                    // BASIC print 输出（保留最近部分）
+    void check_script_idle(const std::string &origin);
+    
+    // ========== Async command queue ==========
+    // 运动命令入队后立即返回ID，由工作线程执行；涉及相同轴的命令按提交顺序串行，
+    // 不同轴的命令互不排队等待。命令体在设备监视器内执行，与 CORBA 线程上的命令串行；
+    // PVT 下发前的等待停轴在监视器外进行（如一轴等待停止时另一轴照常起动）。
+    // 结果经 commandQueue 属性及事件上报。
+    struct AsyncCommand {
+        long id = 0;
+        std::string name;
+        std::string args;                            // JSON
+        std::vector<short> axes;                     // 空表示占用全部轴
+        std::string state;                           // queued/running/done/failed/cancelled
+        std::string error;
+        std::chrono::system_clock::time_point submitted;
+        std::chrono::system_clock::time_point finished;
+    };
+    static const int ASYNC_WORKERS = 2;
+    static const size_t ASYNC_HISTORY = 256;         // 保留的已完成命令记录数
+    std::list<AsyncCommand> async_commands_;         // 按提交顺序：排队/执行中/已完成
+    long async_next_id_{1};
+    std::mutex async_mutex_;
+    std::condition_variable async_cv_;
+    std::vector<std::thread> async_workers_;
+    bool async_stop_{false};
+    std::atomic<bool> async_dirty_{false};           // 有状态变化待推送事件
+    void start_async_workers();
+    void stop_async_workers();
+    void async_worker_loop();
+    void execute_async(const std::string &name, const std::string &args);
+    void settle_axes_for_async(const std::vector<short> &axes, const std::string &origin);
+    std::string async_queue_json();
+    
+    // ========== PVT streaming (conti list) ==========
+    struct PvtStreamChunk {
+        std::vector<double> time;                    // 相对流起点的时间 (s)
+        std::vector<std::vector<double>> pos;        // 每轴相对流起点的位置
+        std::vector<std::vector<double>> vel;        // 每轴规划速度，可省略（为空时按相邻段平均速度估计）
+    };
+    static const size_t PVT_STREAM_MAX_CHUNKS = 2;   // 主机侧最多缓存2块（执行一块、上传一块）
+    static constexpr double PVT_STREAM_RAMP_RATIO = 0.1;  // 段内加减速时间占段时长的比例
+    std::vector<unsigned short> pvt_stream_axes_;
+    unsigned short pvt_stream_crd_;
+    std::deque<PvtStreamChunk> pvt_stream_queue_;
+    bool pvt_stream_closing_;                        // 最后一块已追加
+    std::mutex pvt_stream_mutex_;
+    std::condition_variable pvt_stream_cv_;
+    std::thread pvt_stream_thread_;
+    std::atomic<bool> pvt_stream_active_{false};
+    std::atomic<bool> pvt_stream_stop_{false};
+    std::atomic<long> pvt_stream_pushed_{0};         // 已压入控制器的段数
+    std::string pvt_stream_error_;
+    void pvt_stream_loop();
+    void upload_pvt_tables(const std::vector<short> &axes, size_t count, const double *time,
+                           const std::vector<const double*> &pos, const std::vector<const double*> &vel,
+                           double tolerance, const std::string &origin);
+    void stop_pvt_stream(bool stop_list);
+    
+    // 多轴同步点位运动：经坐标系 MULTI_MOVE_CRD 的直线插补同时起停
+    static const unsigned short MULTI_MOVE_CRD = 0;
+    void move_multi(const Tango::DevVarDoubleArray *argin, bool relative, const char *origin);
+    
     // Internal helpers
     void check_connection();
     void check_error(short error_code, const std::string &context);
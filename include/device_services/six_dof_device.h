@@ -13,11 +13,34 @@
 #include <atomic>
 #include <chrono>
 #include <atomic>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
 
 namespace SixDof {
 
 const int NUM_AXES = 6;
 
+// movePosePvt 规划结果缓存条目：已打包的 setPvtsBinary 参数及轨迹终点状态
+struct PvtCacheEntry {
+    std::vector<int64_t> key;                       // 量化后的请求（含几何哈希）
+    std::vector<double> pvt_packed;                 // setPvtsBinary 参数
+    size_t points = 0;                              // PVT点数
+    std::array<double, NUM_AXES> final_legs{};      // 终点绝对腿长 (mm)
+    std::array<double, NUM_AXES> final_pose{};      // 终点位姿（角度为弧度）
+};
+
+struct PvtCacheKeyHash {
+    size_t operator()(const std::vector<int64_t> &key) const {
+        uint64_t h = 1469598103934665603ULL;        // FNV-1a
+        for (int64_t v : key) {
+            h ^= static_cast<uint64_t>(v);
+            h *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(h);
+    }
+};
+
 class SixDofDevice : public Common::StandardSystemDevice {
 private:
     // Lock system
@@ -62,7 +85,9 @@ private:
     // Runtime state
     std::array<double, NUM_AXES> axis_pos_;        // axisPos - encoder positions
     std::array<double, NUM_AXES> dire_pos_;        // direPos - command positions
-    std::array<double, NUM_AXES> six_freedom_pose_; // sixFreedomPose [X,Y,Z,ThetaX,ThetaY,ThetaZ]
+    std::array<double, NUM_AXES> six_freedom_pose_; // sixFreedomPose [X,Y,Z,ThetaX,ThetaY,ThetaZ] (角度为弧度)
+    Common::Pose fk_pose_;                          // 上一次正解结果（度），作为下一次正解的热启动初值
+    bool fk_converged_{true};                       // 最近一次正解是否收敛；不收敛时 sixFreedomPose 保留上一次结果
     std::array<double, NUM_AXES> current_leg_lengths_; // 当前leg长度（用运动学normalleg初始化）
     std::array<double, NUM_AXES> normal_leg_lengths_; // 初始leg长度
     bool open_brake_state_;                         // openBrakeState
@@ -100,8 +125,32 @@ private:
     // Kinematics
     std::unique_ptr<Common::StewartPlatformKinematics> kinematics_;
     
+    // 同步PVT运动（sdofConfig: syncPvtMove/legMaxVelocity/legMaxAcceleration/legMaxJerk/pvtInterval）
+    std::array<Common::AxisMotionLimits, NUM_AXES> leg_limits_;  // 各腿S曲线约束 (mm/s, mm/s², mm/s³)
+    double pvt_sample_interval_;                                 // PVT采样间隔 (s)
+    bool sync_pvt_move_;                                         // 位姿运动是否使用6轴同步PVT
+    
+    // movePosePvt 规划结果LRU缓存（sdofConfig: pvtCacheSize，0 为关闭）
+    std::list<PvtCacheEntry> pvt_cache_;                         // 最近使用的在前
+    std::unordered_map<std::vector<int64_t>, std::list<PvtCacheEntry>::iterator, PvtCacheKeyHash> pvt_cache_index_;
+    size_t pvt_cache_capacity_;
+    uint64_t pvt_cache_hits_;
+    uint64_t pvt_cache_misses_;
+    int64_t geometry_hash_;                                      // sdofConfig 哈希，几何变化后旧条目自然失效
+    Tango::DevString attr_pvtCacheStats_read;
+    
+    // 长轨迹流式下发（sdofConfig: pvtStreamChunk，每块点数，0 为关闭）。
+    // 控制器侧按点间直线段执行（起止速度取规划速度），与整表 PVT 相比存在弦线及前瞻引入的时序偏差
+    size_t pvt_stream_chunk_;
+    std::thread pvt_stream_thread_;
+    std::atomic<bool> pvt_stream_abort_{false};
+    std::atomic<bool> pvt_stream_failed_{false};                 // 流线程追加失败，待 always_executed_hook 置 FAULT
+    std::mutex pvt_stream_error_mutex_;
+    std::string pvt_stream_error_;
+    
     static const double POS_LIMIT;
     static const double ROT_LIMIT;
+    static const double LIMIT_SNAPSHOT_MAX_AGE_MS;           // 限位联锁可采信的轴状态快照最大时效
     
 public:
     SixDofDevice(Tango::DeviceClass *device_class, std::string &device_name);
@@ -144,6 +193,8 @@ public:
     Tango::DevVarDoubleArray* readEncoder();   // Read all encoder positions
     Tango::DevBoolean readOrg(Tango::DevShort axis);  // Check if axis at origin
     Tango::DevShort readEL(Tango::DevShort axis);     // Read limit switch state
+    Tango::DevVarDoubleArray* checkPoseReachable(const Tango::DevVarDoubleArray *poses); // [reachable, minMargin, firstBadIndex]
+    Tango::DevDouble queryMaxTravel(const Tango::DevVarDoubleArray *direction);          // Max feasible step along pose direction
     
     // Control commands (21-22)
     void stop();                     // Stop all axes
@@ -185,6 +236,7 @@ public:
     void read_result_value(Tango::Attribute &attr);
     void read_driver_power_status(Tango::Attribute &attr);   // 驱动器电源状态
     void read_brake_status(Tango::Attribute &attr);          // 刹车状态
+    void read_pvt_cache_stats(Tango::Attribute &attr);       // PVT规划缓存命中统计（JSON）
     
     // Inherited hooks
     virtual void specific_self_check() override;
@@ -212,6 +264,24 @@ private:
     void update_pose_from_encoders();
     void log_event(const std::string &event);
     void send_move_command(int axis, int position, bool relative);
+    void send_move_command_multi(const std::array<int, NUM_AXES> &positions, bool relative);  // 6腿同步起停
+    void send_pvt_table(const Common::SixAxisPVTTable &table, const std::string &origin);
+    void send_pvt_packed(const std::vector<double> &packed, size_t points, const std::string &origin);
+    std::vector<int64_t> make_pvt_cache_key(const std::vector<std::array<double, NUM_AXES>> &poses,
+                                            const std::vector<double> &times,
+                                            const std::vector<std::array<double, NUM_AXES>> &velocities,
+                                            bool spline, double sample_interval) const;
+    void finish_pose_pvt(std::vector<int64_t> key, const Common::SixAxisPVTTable &table,
+                         const std::array<double, NUM_AXES> &final_legs,
+                         const std::array<double, NUM_AXES> &final_pose);
+    void start_pose_pvt(const PvtCacheEntry &entry);
+    void mark_pose_pvt_started(const std::array<double, NUM_AXES> &final_legs,
+                               const std::array<double, NUM_AXES> &final_pose);
+    void stream_pvt_table(const Common::SixAxisPVTTable &table, const std::string &origin);
+    void pvt_stream_loop(std::shared_ptr<const Common::SixAxisPVTTable> table,
+                         std::shared_ptr<Tango::DeviceProxy> motion, size_t chunk);
+    void abort_pvt_stream();
+    void move_legs_synchronized(const std::array<double, NUM_AXES> &leg_lengths, const std::string &origin);
     void configure_kinematics();
     void check_state(const std::string& cmd_name);
     
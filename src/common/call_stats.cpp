@@ -0,0 +1,160 @@
+#include "common/call_stats.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+namespace Common {
+
+CallHistogram::CallHistogram() {
+    for (auto &b : buckets_) {
+        b.store(0, std::memory_order_relaxed);
+    }
+}
+
+int CallHistogram::bucket_index(uint64_t us) {
+    if (us < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return static_cast<int>(us);  // 第0段：0..15us 每微秒一桶
+    }
+    int magnitude = 0;
+    while ((us >> (magnitude + SUB_BUCKET_BITS)) != 0) {
+        ++magnitude;
+    }
+    if (magnitude > MAGNITUDES) {
+        return BUCKETS - 1;
+    }
+    int sub = static_cast<int>((us >> (magnitude - 1)) & (SUB_BUCKETS - 1));
+    return magnitude * SUB_BUCKETS + sub;
+}
+
+double CallHistogram::bucket_upper_us(int index) {
+    int magnitude = index / SUB_BUCKETS;
+    int sub = index % SUB_BUCKETS;
+    if (magnitude == 0) {
+        return sub + 1.0;
+    }
+    double width = static_cast<double>(1ULL << (magnitude - 1));
+    return (SUB_BUCKETS + sub + 1) * width;
+}
+
+void CallHistogram::record(std::chrono::steady_clock::duration elapsed, bool failed) {
+    uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(0,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    buckets_[bucket_index(ns / 1000)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_ns_.fetch_add(ns, std::memory_order_relaxed);
+    if (failed) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+    uint64_t prev = max_ns_.load(std::memory_order_relaxed);
+    while (ns > prev && !max_ns_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void CallHistogram::reset() {
+    for (auto &b : buckets_) {
+        b.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    errors_.store(0, std::memory_order_relaxed);
+    total_ns_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+}
+
+double CallHistogram::percentile(const std::array<uint64_t, BUCKETS> &counts, uint64_t total, double q) const {
+    if (total == 0) return 0.0;
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total) + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, total));
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return bucket_upper_us(i);
+        }
+    }
+    return bucket_upper_us(BUCKETS - 1);
+}
+
+CallHistogram::Summary CallHistogram::summary() const {
+    // 各计数器分别读取，并发记录时快照可能相差几个样本，统计用途可接受
+    std::array<uint64_t, BUCKETS> counts;
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    Summary s;
+    s.count = count_.load(std::memory_order_relaxed);
+    s.errors = errors_.load(std::memory_order_relaxed);
+    s.mean_us = s.count ? total_ns_.load(std::memory_order_relaxed) / 1000.0 / s.count : 0.0;
+    s.max_us = max_ns_.load(std::memory_order_relaxed) / 1000.0;
+    s.p50_us = std::min(percentile(counts, total, 0.50), s.max_us);
+    s.p90_us = std::min(percentile(counts, total, 0.90), s.max_us);
+    s.p99_us = std::min(percentile(counts, total, 0.99), s.max_us);
+    s.p999_us = std::min(percentile(counts, total, 0.999), s.max_us);
+    return s;
+}
+
+CallStatsRegistry &CallStatsRegistry::instance() {
+    static CallStatsRegistry registry;
+    return registry;
+}
+
+CallHistogram &CallStatsRegistry::histogram(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &slot = histograms_[name];
+    if (!slot) {
+        slot.reset(new CallHistogram());
+    }
+    return *slot;
+}
+
+void CallStatsRegistry::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &kv : histograms_) {
+        kv.second->reset();
+    }
+}
+
+std::string CallStatsRegistry::to_json() const {
+    nlohmann::json j = nlohmann::json::object();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &kv : histograms_) {
+        CallHistogram::Summary s = kv.second->summary();
+        if (s.count == 0) continue;
+        nlohmann::json e;
+        e["count"] = s.count;
+        e["errors"] = s.errors;
+        e["meanUs"] = s.mean_us;
+        e["maxUs"] = s.max_us;
+        e["p50Us"] = s.p50_us;
+        e["p90Us"] = s.p90_us;
+        e["p99Us"] = s.p99_us;
+        e["p999Us"] = s.p999_us;
+        j[kv.first] = e;
+    }
+    return j.dump();
+}
+
+std::string CallStatsRegistry::to_table() const {
+    std::stringstream ss;
+    ss << std::left << std::setw(34) << "call" << std::right
+       << std::setw(10) << "count" << std::setw(8) << "errors"
+       << std::setw(11) << "mean(us)" << std::setw(11) << "p50(us)" << std::setw(11) << "p99(us)"
+       << std::setw(12) << "max(us)" << "\n";
+    std::lock_guard<std::mutex> lock(mutex_);
+    ss << std::fixed << std::setprecision(1);
+    for (const auto &kv : histograms_) {
+        CallHistogram::Summary s = kv.second->summary();
+        if (s.count == 0) continue;
+        ss << std::left << std::setw(34) << kv.first << std::right
+           << std::setw(10) << s.count << std::setw(8) << s.errors
+           << std::setw(11) << s.mean_us << std::setw(11) << s.p50_us << std::setw(11) << s.p99_us
+           << std::setw(12) << s.max_us << "\n";
+    }
+    return ss.str();
+}
+
+} // namespace Common
@@ -2,6 +2,7 @@
 #include <cmath>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -9,6 +10,192 @@
 
 namespace Common {
 
+namespace {
+// 6x6 线性方程组 A*x = b 求解（列主元高斯消元），A 与 b 会被修改
+bool solveLinearSystem6(std::array<std::array<double, 6>, 6>& A, std::array<double, 6>& b,
+                        std::array<double, 6>& x) {
+    for (int col = 0; col < 6; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < 6; ++row) {
+            if (std::fabs(A[row][col]) > std::fabs(A[pivot][col])) pivot = row;
+        }
+        if (std::fabs(A[pivot][col]) < 1e-12) return false;  // 奇异位形
+        if (pivot != col) {
+            std::swap(A[pivot], A[col]);
+            std::swap(b[pivot], b[col]);
+        }
+        for (int row = col + 1; row < 6; ++row) {
+            double factor = A[row][col] / A[col][col];
+            for (int k = col; k < 6; ++k) A[row][k] -= factor * A[col][k];
+            b[row] -= factor * b[col];
+        }
+    }
+    for (int row = 5; row >= 0; --row) {
+        double sum = b[row];
+        for (int k = row + 1; k < 6; ++k) sum -= A[row][k] * x[k];
+        x[row] = sum / A[row][row];
+    }
+    return true;
+}
+
+// 七段式S曲线（对位移绝对值规划），加加速度依次为 +J, 0, -J, 0, -J, 0, +J
+struct SCurve {
+    double total = 0.0;
+    double distance = 0.0;
+    double start[7] = {};
+    double jerk[7] = {};
+    double p0[7] = {}, v0[7] = {}, a0[7] = {};
+};
+
+SCurve makeSCurve(double distance, const AxisMotionLimits& limits) {
+    SCurve c;
+    c.distance = distance;
+    const double V = limits.max_velocity;
+    const double A = limits.max_acceleration;
+    const double J = limits.max_jerk;
+    if (distance <= 0.0 || V <= 0.0 || A <= 0.0 || J <= 0.0) {
+        return c;
+    }
+
+    // 加速段：能达到最大加速度时含匀加速段，否则只有加加速/减加速
+    double Tj, Ta;
+    if (V * J >= A * A) {
+        Tj = A / J;
+        Ta = Tj + V / A;
+    } else {
+        Tj = std::sqrt(V / J);
+        Ta = 2.0 * Tj;
+    }
+    double Tv = distance / V - Ta;   // 加减速对称，加减速段位移之和为 V*Ta
+    if (Tv < 0.0) {
+        // 达不到最大速度：求峰值速度 vp 使 vp*Ta(vp) = distance
+        Tv = 0.0;
+        Tj = A / J;
+        double vp = 0.5 * A * (-Tj + std::sqrt(Tj * Tj + 4.0 * distance / A));
+        if (vp >= A * A / J) {
+            Ta = Tj + vp / A;
+        } else {
+            Tj = std::cbrt(distance / (2.0 * J));
+            Ta = 2.0 * Tj;
+        }
+    }
+
+    const double durations[7] = {Tj, Ta - 2.0 * Tj, Tj, Tv, Tj, Ta - 2.0 * Tj, Tj};
+    const double jerks[7] = {J, 0.0, -J, 0.0, -J, 0.0, J};
+    double t = 0.0, p = 0.0, v = 0.0, a = 0.0;
+    for (int k = 0; k < 7; ++k) {
+        const double d = std::max(durations[k], 0.0);
+        c.start[k] = t;
+        c.jerk[k] = jerks[k];
+        c.p0[k] = p;
+        c.v0[k] = v;
+        c.a0[k] = a;
+        p += v * d + a * d * d / 2.0 + jerks[k] * d * d * d / 6.0;
+        v += a * d + jerks[k] * d * d / 2.0;
+        a += jerks[k] * d;
+        t += d;
+    }
+    c.total = t;
+    return c;
+}
+
+void evaluateSCurve(const SCurve& c, double t, double& pos, double& vel) {
+    if (t >= c.total) {
+        pos = c.distance;
+        vel = 0.0;
+        return;
+    }
+    int k = 6;
+    while (k > 0 && t < c.start[k]) --k;
+    const double tau = std::max(t - c.start[k], 0.0);
+    pos = c.p0[k] + c.v0[k] * tau + c.a0[k] * tau * tau / 2.0 + c.jerk[k] * tau * tau * tau / 6.0;
+    vel = c.v0[k] + c.a0[k] * tau + c.jerk[k] * tau * tau / 2.0;
+}
+
+// 四元数 (w,x,y,z) 运算，用于 SQUAD 姿态插值
+using Quat = std::array<double, 4>;
+
+Quat quatMultiply(const Quat& a, const Quat& b) {
+    return {a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3],
+            a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2],
+            a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1],
+            a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0]};
+}
+
+Quat quatConjugate(const Quat& q) {
+    return {q[0], -q[1], -q[2], -q[3]};
+}
+
+// 单位四元数的对数（返回纯四元数）
+Quat quatLog(const Quat& q) {
+    double v = std::sqrt(q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    if (v < 1e-12) return {0.0, 0.0, 0.0, 0.0};
+    double k = std::atan2(v, q[0]) / v;
+    return {0.0, q[1] * k, q[2] * k, q[3] * k};
+}
+
+// 纯四元数的指数
+Quat quatExp(const Quat& q) {
+    double v = std::sqrt(q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    if (v < 1e-12) return {1.0, q[1], q[2], q[3]};
+    double k = std::sin(v) / v;
+    return {std::cos(v), q[1] * k, q[2] * k, q[3] * k};
+}
+
+Quat quatSlerp(const Quat& a, Quat b, double h) {
+    double dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+    if (dot < 0.0) {
+        dot = -dot;
+        for (double& c : b) c = -c;
+    }
+    double wa, wb;
+    if (dot > 0.9999995) {
+        wa = 1.0 - h;
+        wb = h;
+    } else {
+        double theta = std::acos(dot);
+        double st = std::sin(theta);
+        wa = std::sin((1.0 - h) * theta) / st;
+        wb = std::sin(h * theta) / st;
+    }
+    Quat r = {wa * a[0] + wb * b[0], wa * a[1] + wb * b[1], wa * a[2] + wb * b[2], wa * a[3] + wb * b[3]};
+    double n = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]);
+    for (double& c : r) c /= n;
+    return r;
+}
+
+// R = Rx(rx)*Ry(ry)*Rz(rz)（度）对应的四元数
+Quat eulerToQuat(double rx, double ry, double rz) {
+    const double deg_to_rad = M_PI / 180.0;
+    Quat qx = {std::cos(rx * deg_to_rad / 2), std::sin(rx * deg_to_rad / 2), 0.0, 0.0};
+    Quat qy = {std::cos(ry * deg_to_rad / 2), 0.0, std::sin(ry * deg_to_rad / 2), 0.0};
+    Quat qz = {std::cos(rz * deg_to_rad / 2), 0.0, 0.0, std::sin(rz * deg_to_rad / 2)};
+    return quatMultiply(quatMultiply(qx, qy), qz);
+}
+
+// 四元数转回 Rx*Ry*Rz 欧拉角（度），与 getRotationMatrix 的矩阵元素对应
+void quatToEuler(const Quat& q, double& rx, double& ry, double& rz) {
+    const double rad_to_deg = 180.0 / M_PI;
+    const double w = q[0], x = q[1], y = q[2], z = q[3];
+    double r00 = 1 - 2 * (y * y + z * z);
+    double r01 = 2 * (x * y - w * z);
+    double r02 = 2 * (x * z + w * y);
+    double r12 = 2 * (y * z - w * x);
+    double r22 = 1 - 2 * (x * x + y * y);
+    ry = std::asin(std::max(-1.0, std::min(1.0, r02))) * rad_to_deg;
+    rx = std::atan2(-r12, r22) * rad_to_deg;
+    rz = std::atan2(-r01, r00) * rad_to_deg;
+}
+
+// PVT区间内的三次Hermite插补（与控制器PVT插补方式一致）
+double hermiteAt(double t0, double p0, double v0, double t1, double p1, double v1, double t) {
+    const double h = t1 - t0;
+    const double u = (t - t0) / h;
+    const double u2 = u * u, u3 = u2 * u;
+    return (2 * u3 - 3 * u2 + 1) * p0 + (u3 - 2 * u2 + u) * h * v0 +
+           (-2 * u3 + 3 * u2) * p1 + (u3 - u2) * h * v1;
+}
+} // namespace
 
 StewartPlatformKinematics::StewartPlatformKinematics(const PlatformGeometry& geometry)
         : geometry_(geometry), nominal_leg_length_(geometry.nominal_leg_length) {
@@ -59,7 +246,7 @@ void StewartPlatformKinematics::initializeGeometry() {
     }
 }
 
-void StewartPlatformKinematics::getRotationMatrix(double rx, double ry, double rz, std::array<std::array<double, 3>, 3>& R) {
+void StewartPlatformKinematics::getRotationMatrix(double rx, double ry, double rz, std::array<std::array<double, 3>, 3>& R) const {
     // 标准 Rx * Ry * Rz 旋转矩阵（已修正）
     // rx=aa(Roll), ry=bb(Pitch), rz=cc(Yaw)
     // 对应 BGsystem 的 arf, br, cr
@@ -101,6 +288,185 @@ void StewartPlatformKinematics::getRotationMatrix(double rx, double ry, double r
     R[2][2] = cb * ca;
 }
 
+void StewartPlatformKinematics::getRotationMatrixDerivatives(double rx, double ry, double rz,
+                                                             std::array<std::array<std::array<double, 3>, 3>, 3>& dR) const {
+    // 对 getRotationMatrix 的解析求导，角度单位为度，因此整体乘以 deg_to_rad
+    const double deg_to_rad = M_PI / 180.0;
+    double ca = cos(rx * deg_to_rad), sa = sin(rx * deg_to_rad);
+    double cb = cos(ry * deg_to_rad), sb = sin(ry * deg_to_rad);
+    double cc = cos(rz * deg_to_rad), sc = sin(rz * deg_to_rad);
+
+    // dR/drx
+    dR[0] = {{{0.0, 0.0, 0.0},
+              {cc * sb * ca - sa * sc, -cc * sa - sc * sb * ca, -ca * cb},
+              {ca * sc + sa * sb * cc, ca * cc - sa * sb * sc, -cb * sa}}};
+    // dR/dry
+    dR[1] = {{{-cc * sb, sb * sc, cb},
+              {cc * cb * sa, -sc * cb * sa, sa * sb},
+              {-ca * cb * cc, ca * cb * sc, -sb * ca}}};
+    // dR/drz
+    dR[2] = {{{-sc * cb, -cb * cc, 0.0},
+              {ca * cc - sc * sb * sa, -sc * ca - cc * sb * sa, 0.0},
+              {sa * cc + ca * sb * sc, ca * sb * cc - sa * sc, 0.0}}};
+
+    for (auto& m : dR)
+        for (auto& row : m)
+            for (double& v : row) v *= deg_to_rad;
+}
+
+void StewartPlatformKinematics::calculateLegJacobian(const Pose& pose, std::array<double, 6>& leg_lengths,
+                                                     std::array<std::array<double, 6>, 6>& J) const {
+    std::array<std::array<double, 3>, 3> R;
+    std::array<std::array<std::array<double, 3>, 3>, 3> dR;
+    getRotationMatrix(pose.rx, pose.ry, pose.rz, R);
+    getRotationMatrixDerivatives(pose.rx, pose.ry, pose.rz, dR);
+    double T[3] = {pose.x, pose.y, pose.z + geometry_.initial_height};
+
+    for (int i = 0; i < 6; ++i) {
+        const auto& p = platform_points_[i];
+        double l[3];
+        for (int m = 0; m < 3; ++m) {
+            l[m] = T[m] + R[m][0] * p[0] + R[m][1] * p[1] + R[m][2] * p[2] - base_points_[i][m];
+        }
+        double length = sqrt(l[0] * l[0] + l[1] * l[1] + l[2] * l[2]);
+        leg_lengths[i] = length;
+
+        // dL/dT = l/|l|，dL/dθ = (l/|l|)·(dR/dθ·p)
+        double u[3] = {l[0] / length, l[1] / length, l[2] / length};
+        J[i][0] = u[0];
+        J[i][1] = u[1];
+        J[i][2] = u[2];
+        for (int k = 0; k < 3; ++k) {
+            double d = 0.0;
+            for (int m = 0; m < 3; ++m) {
+                d += u[m] * (dR[k][m][0] * p[0] + dR[k][m][1] * p[1] + dR[k][m][2] * p[2]);
+            }
+            J[i][3 + k] = d;
+        }
+    }
+}
+
+double StewartPlatformKinematics::calculateLegMargin(const Pose& pose) const {
+    PoseBatchView view{&pose.x, &pose.y, &pose.z, &pose.rx, &pose.ry, &pose.rz, 1};
+    std::array<double, 6> leg_lengths;
+    calculateInverseKinematicsBatch(view, &leg_lengths);
+
+    const double min_len = geometry_.min_leg_length > 0 ? geometry_.min_leg_length : -HUGE_VAL;
+    const double max_len = geometry_.max_leg_length > 0 ? geometry_.max_leg_length : HUGE_VAL;
+    double margin = HUGE_VAL;
+    for (int i = 0; i < 6; ++i) {
+        margin = std::min(margin, std::min(leg_lengths[i] - min_len, max_len - leg_lengths[i]));
+    }
+    return margin;
+}
+
+double StewartPlatformKinematics::calculateMaxTravel(const Pose& start, const std::array<double, 6>& direction,
+                                                     double max_step, double tolerance) const {
+    auto feasible = [&](double s) {
+        Pose p(start.x + s * direction[0], start.y + s * direction[1], start.z + s * direction[2],
+               start.rx + s * direction[3], start.ry + s * direction[4], start.rz + s * direction[5]);
+        std::array<double, 6> z_displacements;
+        return calculateLegMargin(p) > 0.0 && calculateZAxisDisplacement(p, z_displacements);
+    };
+
+    if (max_step <= 0.0 || !feasible(0.0)) {
+        return 0.0;
+    }
+    if (feasible(max_step)) {
+        return max_step;
+    }
+    // 工作空间在运行范围内沿射线连通，从可行的起点二分即可
+    double ok = 0.0;
+    double bad = max_step;
+    while (bad - ok > tolerance) {
+        double mid = 0.5 * (ok + bad);
+        if (feasible(mid)) ok = mid; else bad = mid;
+    }
+    return ok;
+}
+
+void StewartPlatformKinematics::calculateInverseJacobian(const Pose& pose,
+                                                         std::array<std::array<double, 6>, 6>& J) const {
+    std::array<double, 6> leg_lengths;
+    calculateLegJacobian(pose, leg_lengths, J);
+}
+
+void StewartPlatformKinematics::calculateLegVelocities(const Pose& pose,
+                                                       const std::array<double, 6>& pose_rate,
+                                                       std::array<double, 6>& leg_velocities) const {
+    std::array<std::array<double, 6>, 6> J;
+    calculateInverseJacobian(pose, J);
+    for (int i = 0; i < 6; ++i) {
+        double v = 0.0;
+        for (int j = 0; j < 6; ++j) {
+            v += J[i][j] * pose_rate[j];
+        }
+        leg_velocities[i] = v;
+    }
+}
+
+void StewartPlatformKinematics::calculateLegVelocitiesFromTwist(const Pose& pose,
+                                                                const std::array<double, 6>& twist,
+                                                                std::array<double, 6>& leg_velocities) const {
+    const double deg_to_rad = M_PI / 180.0;
+    std::array<std::array<double, 3>, 3> R;
+    getRotationMatrix(pose.rx, pose.ry, pose.rz, R);
+    double T[3] = {pose.x, pose.y, pose.z + geometry_.initial_height};
+    double w[3] = {twist[3] * deg_to_rad, twist[4] * deg_to_rad, twist[5] * deg_to_rad};
+
+    for (int i = 0; i < 6; ++i) {
+        const auto& p = platform_points_[i];
+        double r[3], l[3];
+        for (int m = 0; m < 3; ++m) {
+            r[m] = R[m][0] * p[0] + R[m][1] * p[1] + R[m][2] * p[2];
+            l[m] = T[m] + r[m] - base_points_[i][m];
+        }
+        double length = sqrt(l[0] * l[0] + l[1] * l[1] + l[2] * l[2]);
+        // 铰点速度 = v + ω × r
+        double pv[3] = {twist[0] + w[1] * r[2] - w[2] * r[1],
+                        twist[1] + w[2] * r[0] - w[0] * r[2],
+                        twist[2] + w[0] * r[1] - w[1] * r[0]};
+        leg_velocities[i] = (l[0] * pv[0] + l[1] * pv[1] + l[2] * pv[2]) / length;
+    }
+}
+
+bool StewartPlatformKinematics::calculateForwardKinematics(const std::array<double, 6>& leg_lengths,
+                                                           const Pose& initial_guess, Pose& pose,
+                                                           int* iterations) const {
+    double q[6] = {initial_guess.x, initial_guess.y, initial_guess.z,
+                   initial_guess.rx, initial_guess.ry, initial_guess.rz};
+    std::array<double, 6> lengths;
+    std::array<std::array<double, 6>, 6> J;
+
+    for (int iter = 0; iter < FK_MAX_ITERATIONS; ++iter) {
+        Pose current(q[0], q[1], q[2], q[3], q[4], q[5]);
+        calculateLegJacobian(current, lengths, J);
+
+        std::array<double, 6> residual;
+        double max_residual = 0.0;
+        for (int i = 0; i < 6; ++i) {
+            residual[i] = leg_lengths[i] - lengths[i];
+            max_residual = std::max(max_residual, std::fabs(residual[i]));
+        }
+        if (max_residual < FK_TOLERANCE) {
+            pose = current;
+            if (iterations) *iterations = iter;
+            return true;
+        }
+
+        // Newton 步：J * dq = L_target - L(q)
+        std::array<double, 6> dq;
+        if (!solveLinearSystem6(J, residual, dq)) {
+            if (iterations) *iterations = iter;
+            return false;
+        }
+        for (int j = 0; j < 6; ++j) q[j] += dq[j];
+    }
+
+    if (iterations) *iterations = FK_MAX_ITERATIONS;
+    return false;
+}
+
 void StewartPlatformKinematics::calculateNominalLegLength() {
     // 若外部已配置标称腿长，则直接使用（避免被自动计算覆盖）
     // if (geometry_.nominal_leg_length > 0) {
@@ -127,16 +493,8 @@ void StewartPlatformKinematics::getPlatformPoints(std::array<std::array<double,
 bool StewartPlatformKinematics::calculateInverseKinematics(const Pose& pose, std::array<double, 6>& leg_lengths) {
     std::array<std::array<double, 3>, 3> R;
     getRotationMatrix(pose.rx, pose.ry, pose.rz, R);
-    std::cout << pose.rx << ", " << pose.ry << ", " << pose.rz << std::endl;
-    std::cout << "R: " << std::endl;
-    for (int i = 0; i < 3; ++i) {   
-        std::cout << R[i][0] << ", " << R[i][1] << ", " << R[i][2] << std::endl;
-    }
-    std::cout << "cal done!" << std::endl;
     // Translation vector T
-    std::cout << "Pose: " << pose.x << ", " << pose.y << ", " << pose.z << ", " << geometry_.initial_height << std::endl;
     double T[3] = {pose.x, pose.y, pose.z + geometry_.initial_height};
-    std::cout << "T: " << T[0] << ", " << T[1] << ", " << T[2] << std::endl;
 
     for (int i = 0; i < 6; ++i) {
         // Calculate transformed platform point: q_i = T + R * p_i
@@ -144,19 +502,15 @@ bool StewartPlatformKinematics::calculateInverseKinematics(const Pose& pose, std
         q[0] = T[0] + R[0][0] * platform_points_[i][0] + R[0][1] * platform_points_[i][1] + R[0][2] * platform_points_[i][2];
         q[1] = T[1] + R[1][0] * platform_points_[i][0] + R[1][1] * platform_points_[i][1] + R[1][2] * platform_points_[i][2];
         q[2] = T[2] + R[2][0] * platform_points_[i][0] + R[2][1] * platform_points_[i][1] + R[2][2] * platform_points_[i][2];
-        std::cout << "q[" << i << "]: " << q[0] << ", " << q[1] << ", " << q[2] << std::endl;
 
         // Calculate vector l_i = q_i - b_i
         double l[3];
         l[0] = q[0] - base_points_[i][0];
         l[1] = q[1] - base_points_[i][1];
         l[2] = q[2] - base_points_[i][2];
-        std::cout << "l[" << i << "]: " << l[0] << ", " << l[1] << ", " << l[2] << std::endl;
 
         // Calculate length
         double length = sqrt(l[0] * l[0] + l[1] * l[1] + l[2] * l[2]);
-        std::cout << std::fixed << std::setprecision(4);
-        std::cout << "Leg " << i << " length: " << length << std::endl;
         // Check limits (if limits are set to 0, ignore them for now or assume valid)
         if (geometry_.min_leg_length > 0 && length < geometry_.min_leg_length) return false;
         if (geometry_.max_leg_length > 0 && length > geometry_.max_leg_length) return false;
@@ -166,6 +520,72 @@ bool StewartPlatformKinematics::calculateInverseKinematics(const Pose& pose, std
     return true;
 }
 
+size_t StewartPlatformKinematics::calculateInverseKinematicsBatch(const PoseBatchView& poses,
+                                                                  std::array<double, 6>* leg_lengths,
+                                                                  unsigned char* reachable) const {
+    const double deg_to_rad = M_PI / 180.0;
+    const double min_len = geometry_.min_leg_length > 0 ? geometry_.min_leg_length : 0.0;
+    const double max_len = geometry_.max_leg_length > 0 ? geometry_.max_leg_length : HUGE_VAL;
+    size_t unreachable = 0;
+
+    // 块内中间量放在栈上：旋转矩阵9个元素 + 平移，按点连续存放
+    double r00[IK_BATCH_BLOCK], r01[IK_BATCH_BLOCK], r02[IK_BATCH_BLOCK];
+    double r10[IK_BATCH_BLOCK], r11[IK_BATCH_BLOCK], r12[IK_BATCH_BLOCK];
+    double r20[IK_BATCH_BLOCK], r21[IK_BATCH_BLOCK], r22[IK_BATCH_BLOCK];
+    double tx[IK_BATCH_BLOCK], ty[IK_BATCH_BLOCK], tz[IK_BATCH_BLOCK];
+    double len[6][IK_BATCH_BLOCK];
+
+    for (size_t start = 0; start < poses.count; start += IK_BATCH_BLOCK) {
+        const size_t n = std::min(IK_BATCH_BLOCK, poses.count - start);
+
+        // 第一步：每个位姿计算一次旋转矩阵（与 getRotationMatrix 相同的 Rx*Ry*Rz）
+        for (size_t k = 0; k < n; ++k) {
+            const size_t i = start + k;
+            const double ca = cos(poses.rx[i] * deg_to_rad), sa = sin(poses.rx[i] * deg_to_rad);
+            const double cb = cos(poses.ry[i] * deg_to_rad), sb = sin(poses.ry[i] * deg_to_rad);
+            const double cc = cos(poses.rz[i] * deg_to_rad), sc = sin(poses.rz[i] * deg_to_rad);
+            r00[k] = cc * cb;
+            r01[k] = -cb * sc;
+            r02[k] = sb;
+            r10[k] = cc * sb * sa + ca * sc;
+            r11[k] = cc * ca - sc * sb * sa;
+            r12[k] = -sa * cb;
+            r20[k] = sa * sc - ca * sb * cc;
+            r21[k] = ca * sb * sc + sa * cc;
+            r22[k] = cb * ca;
+            tx[k] = poses.x[i];
+            ty[k] = poses.y[i];
+            tz[k] = poses.z[i] + geometry_.initial_height;
+        }
+
+        // 第二步：逐腿计算，内层循环为无分支的纯算术，可被自动向量化
+        for (int j = 0; j < 6; ++j) {
+            const double px = platform_points_[j][0], py = platform_points_[j][1], pz = platform_points_[j][2];
+            const double bx = base_points_[j][0], by = base_points_[j][1], bz = base_points_[j][2];
+            double* out = len[j];
+            for (size_t k = 0; k < n; ++k) {
+                const double lx = tx[k] + r00[k] * px + r01[k] * py + r02[k] * pz - bx;
+                const double ly = ty[k] + r10[k] * px + r11[k] * py + r12[k] * pz - by;
+                const double lz = tz[k] + r20[k] * px + r21[k] * py + r22[k] * pz - bz;
+                out[k] = std::sqrt(lx * lx + ly * ly + lz * lz);
+            }
+        }
+
+        // 第三步：写回输出并检查腿长范围
+        for (size_t k = 0; k < n; ++k) {
+            bool ok = true;
+            for (int j = 0; j < 6; ++j) {
+                const double l = len[j][k];
+                leg_lengths[start + k][j] = l;
+                ok = ok && l >= min_len && l <= max_len;
+            }
+            if (reachable) reachable[start + k] = ok ? 1 : 0;
+            if (!ok) ++unreachable;
+        }
+    }
+    return unreachable;
+}
+
 bool StewartPlatformKinematics::calculateDisplacement(const Pose& target_pose,
                               const std::array<double, 6>& current_leg_lengths,
                               std::array<double, 6>& delta_lengths) {
@@ -203,7 +623,7 @@ void StewartPlatformKinematics::convertTargetPoseToPlatformPose(const Pose& targ
     platform_pose.z = target_pose.z + geometry_.H_target_upd + geometry_.H_upd_up;
 }
 
-bool StewartPlatformKinematics::calculateZAxisDisplacement(const Pose& pose, std::array<double, 6>& z_displacements) {
+bool StewartPlatformKinematics::calculateZAxisDisplacement(const Pose& pose, std::array<double, 6>& z_displacements) const {
     // BGsystem风格：计算各腿的Z轴投影位移
     // 用于垂直驱动杆的Stewart平台，驱动杆只沿Z轴运动
     // 重要：pose必须是"上平台铰点面"的位姿，不是靶点！
@@ -325,6 +745,144 @@ bool StewartPlatformKinematics::calculateZAxisDisplacementFromTarget(const Pose&
 }
 
 // ================== TrajectoryPlanner 实现 ==================
+bool PoseSpline::build(const std::vector<Pose>& keyframes, const std::vector<double>& times) {
+    const size_t n = keyframes.size();
+    if (n < 2 || times.size() != n) {
+        return false;
+    }
+    for (size_t i = 1; i < n; ++i) {
+        if (times[i] <= times[i - 1]) return false;
+    }
+    times_ = times;
+
+    // 位置：夹持三次样条（起止速度为0），求解节点二阶导的三对角方程组
+    for (int axis = 0; axis < 3; ++axis) {
+        std::vector<double>& y = position_[axis];
+        y.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            y[i] = axis == 0 ? keyframes[i].x : (axis == 1 ? keyframes[i].y : keyframes[i].z);
+        }
+        std::vector<double> a(n), b(n), c(n), d(n);
+        for (size_t i = 0; i < n; ++i) {
+            double h_prev = i > 0 ? times[i] - times[i - 1] : 0.0;
+            double h_next = i + 1 < n ? times[i + 1] - times[i] : 0.0;
+            double slope_prev = i > 0 ? (y[i] - y[i - 1]) / h_prev : 0.0;
+            double slope_next = i + 1 < n ? (y[i + 1] - y[i]) / h_next : 0.0;
+            a[i] = h_prev;
+            b[i] = 2.0 * (h_prev + h_next);
+            c[i] = h_next;
+            d[i] = 6.0 * (slope_next - slope_prev);   // 端点处端点速度为0
+        }
+        // Thomas 算法
+        for (size_t i = 1; i < n; ++i) {
+            double m = a[i] / b[i - 1];
+            b[i] -= m * c[i - 1];
+            d[i] -= m * d[i - 1];
+        }
+        std::vector<double>& M = second_deriv_[axis];
+        M.assign(n, 0.0);
+        M[n - 1] = d[n - 1] / b[n - 1];
+        for (size_t i = n - 1; i-- > 0;) {
+            M[i] = (d[i] - c[i] * M[i + 1]) / b[i];
+        }
+    }
+
+    // 姿态：关键帧四元数（保持同一半球）及 SQUAD 控制点
+    quat_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        quat_[i] = eulerToQuat(keyframes[i].rx, keyframes[i].ry, keyframes[i].rz);
+        if (i > 0) {
+            const Quat& p = quat_[i - 1];
+            double dot = p[0] * quat_[i][0] + p[1] * quat_[i][1] + p[2] * quat_[i][2] + p[3] * quat_[i][3];
+            if (dot < 0.0) {
+                for (double& c : quat_[i]) c = -c;
+            }
+        }
+    }
+    // 端点控制点取使端点角速度为0的值，与位置样条的起止静止条件一致
+    auto rest_ctrl = [](const Quat& q, const Quat& neighbor) {
+        Quat l = quatLog(quatMultiply(quatConjugate(q), neighbor));
+        return quatMultiply(q, quatExp({0.0, -l[1] / 2.0, -l[2] / 2.0, -l[3] / 2.0}));
+    };
+    squad_ctrl_.resize(n);
+    squad_ctrl_[0] = rest_ctrl(quat_[0], quat_[1]);
+    squad_ctrl_[n - 1] = rest_ctrl(quat_[n - 1], quat_[n - 2]);
+    for (size_t i = 1; i + 1 < n; ++i) {
+        Quat inv = quatConjugate(quat_[i]);
+        Quat l1 = quatLog(quatMultiply(inv, quat_[i + 1]));
+        Quat l0 = quatLog(quatMultiply(inv, quat_[i - 1]));
+        Quat e = {0.0, -(l1[1] + l0[1]) / 4.0, -(l1[2] + l0[2]) / 4.0, -(l1[3] + l0[3]) / 4.0};
+        squad_ctrl_[i] = quatMultiply(quat_[i], quatExp(e));
+    }
+    return true;
+}
+
+size_t PoseSpline::segmentIndex(double t) const {
+    size_t i = std::upper_bound(times_.begin(), times_.end(), t) - times_.begin();
+    if (i == 0) return 0;
+    return std::min(i - 1, times_.size() - 2);
+}
+
+void PoseSpline::evaluateOrientation(double t, double& rx, double& ry, double& rz) const {
+    size_t i = segmentIndex(t);
+    double h = (t - times_[i]) / (times_[i + 1] - times_[i]);
+    h = std::max(0.0, std::min(1.0, h));
+    Quat q = quatSlerp(quatSlerp(quat_[i], quat_[i + 1], h),
+                       quatSlerp(squad_ctrl_[i], squad_ctrl_[i + 1], h), 2.0 * h * (1.0 - h));
+    quatToEuler(q, rx, ry, rz);
+}
+
+void PoseSpline::evaluate(double t, Pose& pose, std::array<double, 6>* pose_velocity) const {
+    t = std::max(startTime(), std::min(endTime(), t));
+    size_t i = segmentIndex(t);
+    const double h = times_[i + 1] - times_[i];
+    const double A = (times_[i + 1] - t) / h;
+    const double B = (t - times_[i]) / h;
+    double pos[3], vel[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        const std::vector<double>& y = position_[axis];
+        const std::vector<double>& M = second_deriv_[axis];
+        pos[axis] = A * y[i] + B * y[i + 1] + ((A * A * A - A) * M[i] + (B * B * B - B) * M[i + 1]) * h * h / 6.0;
+        vel[axis] = (y[i + 1] - y[i]) / h + (-(3.0 * A * A - 1.0) * M[i] + (3.0 * B * B - 1.0) * M[i + 1]) * h / 6.0;
+    }
+    pose.x = pos[0];
+    pose.y = pos[1];
+    pose.z = pos[2];
+    evaluateOrientation(t, pose.rx, pose.ry, pose.rz);
+
+    if (pose_velocity) {
+        // 欧拉角速率用中心差分（端点处单边）
+        const double dt = 1e-5;
+        double t0 = std::max(startTime(), t - dt), t1 = std::min(endTime(), t + dt);
+        double a[3], b[3];
+        evaluateOrientation(t0, a[0], a[1], a[2]);
+        evaluateOrientation(t1, b[0], b[1], b[2]);
+        for (int axis = 0; axis < 3; ++axis) {
+            (*pose_velocity)[axis] = vel[axis];
+            (*pose_velocity)[3 + axis] = t1 > t0 ? (b[axis] - a[axis]) / (t1 - t0) : 0.0;
+        }
+    }
+}
+
+void PoseSpline::sample(double interval, PoseBatch& batch, std::vector<double>& times,
+                        std::vector<std::array<double, 6>>* pose_velocities) const {
+    const double duration = endTime() - startTime();
+    if (interval <= 0.0) interval = TrajectoryPlanner::DEFAULT_PVT_INTERVAL;
+    const size_t segments = std::max<size_t>(1, static_cast<size_t>(std::ceil(duration / interval - 1e-9)));
+    const double dt = duration / segments;
+
+    batch.resize(segments + 1);
+    times.resize(segments + 1);
+    if (pose_velocities) pose_velocities->resize(segments + 1);
+    for (size_t k = 0; k <= segments; ++k) {
+        double t = (k == segments) ? duration : k * dt;
+        Pose pose;
+        evaluate(startTime() + t, pose, pose_velocities ? &(*pose_velocities)[k] : nullptr);
+        batch.set(k, pose);
+        times[k] = t;
+    }
+}
+
 double TrajectoryPlanner::planCosineProfile(double displacement, int speed_level,
                                     std::vector<PVTPoint>& trajectory) {
     // 速度等级越高，时间越短 (speed_level: 1-9)
@@ -365,6 +923,331 @@ double TrajectoryPlanner::planSixAxisTrajectory(const std::array<double, 6>& dis
     return max_time;
 }
 
+double TrajectoryPlanner::sCurveMinimumTime(double displacement, const AxisMotionLimits& limits) {
+    return makeSCurve(std::fabs(displacement), limits).total;
+}
+
+double TrajectoryPlanner::planSCurveProfile(double displacement, const AxisMotionLimits& limits,
+                                            std::vector<PVTPoint>& trajectory, double sample_interval) {
+    const double sign = displacement < 0.0 ? -1.0 : 1.0;
+    SCurve curve = makeSCurve(std::fabs(displacement), limits);
+
+    trajectory.clear();
+    trajectory.push_back({0.0, 0.0, 0.0});
+    if (curve.total <= 0.0) {
+        return 0.0;
+    }
+    // 等间隔采样，间隔不超过 sample_interval，终点精确落在 total 上
+    if (sample_interval <= 0.0) sample_interval = DEFAULT_PVT_INTERVAL;
+    const int segments = std::max(1, static_cast<int>(std::ceil(curve.total / sample_interval - 1e-9)));
+    const double dt = curve.total / segments;
+    trajectory.reserve(segments + 1);
+    for (int i = 1; i <= segments; ++i) {
+        double t = (i == segments) ? curve.total : i * dt;
+        double pos, vel;
+        evaluateSCurve(curve, t, pos, vel);
+        trajectory.push_back({sign * pos, sign * vel, t});
+    }
+    return curve.total;
+}
+
+double TrajectoryPlanner::planSixAxisSCurve(const std::array<double, 6>& displacements,
+                                            const std::array<AxisMotionLimits, 6>& limits,
+                                            std::array<std::vector<PVTPoint>, 6>& trajectories,
+                                            double sample_interval) {
+    double max_time = 0.0;
+    for (int axis = 0; axis < 6; ++axis) {
+        double t = planSCurveProfile(displacements[axis], limits[axis], trajectories[axis], sample_interval);
+        if (t > max_time) max_time = t;
+    }
+    return max_time;
+}
+
+double TrajectoryPlanner::planSynchronizedSixAxis(const std::array<double, 6>& displacements,
+                                                  const std::array<AxisMotionLimits, 6>& limits,
+                                                  SixAxisPVTTable& table, double sample_interval) {
+    // 归一化路径参数 s∈[0,1] 的约束：各腿约束除以各腿位移，取最严格者
+    AxisMotionLimits path_limits(HUGE_VAL, HUGE_VAL, HUGE_VAL);
+    for (int axis = 0; axis < 6; ++axis) {
+        const double d = std::fabs(displacements[axis]);
+        if (d < 1e-9) continue;
+        path_limits.max_velocity = std::min(path_limits.max_velocity, limits[axis].max_velocity / d);
+        path_limits.max_acceleration = std::min(path_limits.max_acceleration, limits[axis].max_acceleration / d);
+        path_limits.max_jerk = std::min(path_limits.max_jerk, limits[axis].max_jerk / d);
+    }
+
+    std::vector<PVTPoint> path;
+    double total = 0.0;
+    if (path_limits.max_velocity < HUGE_VAL) {
+        total = planSCurveProfile(1.0, path_limits, path, sample_interval);
+    } else {
+        path.push_back({0.0, 0.0, 0.0});   // 全部位移为0
+    }
+
+    table.time.resize(path.size());
+    for (int axis = 0; axis < 6; ++axis) {
+        table.position[axis].resize(path.size());
+        table.velocity[axis].resize(path.size());
+    }
+    for (size_t i = 0; i < path.size(); ++i) {
+        table.time[i] = path[i].time;
+        for (int axis = 0; axis < 6; ++axis) {
+            table.position[axis][i] = displacements[axis] * path[i].position;
+            table.velocity[axis][i] = displacements[axis] * path[i].velocity;
+        }
+    }
+    // 终点精确等于目标位移
+    for (int axis = 0; axis < 6; ++axis) {
+        table.position[axis].back() = displacements[axis];
+    }
+    return total;
+}
+
+std::vector<size_t> TrajectoryPlanner::reducePVTPoints(const double* time, const double* pos, const double* vel,
+                                                      size_t count, double tolerance) {
+    std::vector<size_t> kept;
+    if (count <= 2 || tolerance <= 0.0) {
+        kept.resize(count);
+        for (size_t i = 0; i < count; ++i) kept[i] = i;
+        return kept;
+    }
+
+    std::vector<unsigned char> keep(count, 0);
+    keep[0] = keep[count - 1] = 1;
+
+    // 非递归 Douglas-Peucker：区间 [a,b] 用端点的 P/V 构造 Hermite 曲线，
+    // 检查内部原始点及每个原始区间中点处的偏差，超差则在偏差最大的原始点处拆分
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.emplace_back(0, count - 1);
+    while (!stack.empty()) {
+        size_t a = stack.back().first, b = stack.back().second;
+        stack.pop_back();
+        if (b - a < 1) continue;
+
+        double max_err = 0.0;
+        size_t split = a;
+        for (size_t i = a; i < b; ++i) {
+            // 原始区间 [i,i+1] 中点
+            double tm = 0.5 * (time[i] + time[i + 1]);
+            double orig = hermiteAt(time[i], pos[i], vel[i], time[i + 1], pos[i + 1], vel[i + 1], tm);
+            double err = std::fabs(hermiteAt(time[a], pos[a], vel[a], time[b], pos[b], vel[b], tm) - orig);
+            if (err > max_err) {
+                max_err = err;
+                split = (i == a) ? i + 1 : i;   // 中点超差时在该区间的内部端点拆分
+            }
+            if (i > a) {
+                err = std::fabs(hermiteAt(time[a], pos[a], vel[a], time[b], pos[b], vel[b], time[i]) - pos[i]);
+                if (err > max_err) {
+                    max_err = err;
+                    split = i;
+                }
+            }
+        }
+        if (max_err > tolerance && b - a > 1) {
+            if (split <= a || split >= b) split = a + (b - a) / 2;
+            keep[split] = 1;
+            stack.emplace_back(a, split);
+            stack.emplace_back(split, b);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (keep[i]) kept.push_back(i);
+    }
+    return kept;
+}
+
+double TrajectoryPlanner::planTimeOptimalPath(const StewartPlatformKinematics& kinematics,
+                                              const std::vector<Pose>& waypoints,
+                                              const std::array<AxisMotionLimits, 6>& limits,
+                                              SixAxisPVTTable& table,
+                                              double sample_interval, int samples_per_segment) {
+    table = SixAxisPVTTable();
+    if (waypoints.empty() || samples_per_segment < 1) {
+        return -1.0;
+    }
+
+    // 去掉重复路点；路径参数 s 取位姿空间弧长（mm 与 度 等权，仅作参数化用）
+    auto distance = [](const Pose& a, const Pose& b) {
+        double d[6] = {b.x - a.x, b.y - a.y, b.z - a.z, b.rx - a.rx, b.ry - a.ry, b.rz - a.rz};
+        double sum = 0.0;
+        for (double v : d) sum += v * v;
+        return std::sqrt(sum);
+    };
+    std::vector<Pose> path;
+    path.push_back(waypoints.front());
+    for (size_t i = 1; i < waypoints.size(); ++i) {
+        if (distance(path.back(), waypoints[i]) > 1e-9) path.push_back(waypoints[i]);
+    }
+
+    // 第一步：离散路径（路点间线性插值），批量逆解得到腿长 q(s)
+    const size_t segments = path.size() - 1;
+    const size_t n = segments * samples_per_segment + 1;
+    PoseBatch batch;
+    batch.resize(n);
+    std::vector<double> s(n, 0.0);
+    std::vector<double> step(std::max<size_t>(segments, 1), 0.0);   // 每段的离散步长
+    for (size_t k = 0; k < n; ++k) {
+        size_t seg = std::min(k / samples_per_segment, segments > 0 ? segments - 1 : 0);
+        if (segments == 0) {
+            batch.set(k, path.front());
+            break;
+        }
+        double r = static_cast<double>(k - seg * samples_per_segment) / samples_per_segment;
+        const Pose& a = path[seg];
+        const Pose& b = path[seg + 1];
+        batch.set(k, Pose(a.x + r * (b.x - a.x), a.y + r * (b.y - a.y), a.z + r * (b.z - a.z),
+                          a.rx + r * (b.rx - a.rx), a.ry + r * (b.ry - a.ry), a.rz + r * (b.rz - a.rz)));
+        step[seg] = distance(a, b) / samples_per_segment;
+        if (k > 0) s[k] = s[k - 1] + step[std::min((k - 1) / samples_per_segment, segments - 1)];
+    }
+    std::vector<std::array<double, 6>> q(n);
+    if (kinematics.calculateInverseKinematicsBatch(batch.view(), q.data()) > 0) {
+        return -1.0;
+    }
+    if (segments == 0) {
+        table.time.push_back(0.0);
+        for (int i = 0; i < 6; ++i) {
+            table.position[i].push_back(0.0);
+            table.velocity[i].push_back(0.0);
+        }
+        return 0.0;
+    }
+
+    // 第二步：q'(s)、q''(s) 差分。路点处（段边界）取两侧单边差分，方向不同的拐点必须停下
+    std::vector<std::array<double, 6>> dq(n), ddq(n);
+    std::vector<bool> stop(n, false);
+    stop[0] = stop[n - 1] = true;
+    for (size_t k = 0; k < n; ++k) {
+        const bool boundary = (k % samples_per_segment) == 0;
+        for (int i = 0; i < 6; ++i) ddq[k][i] = 0.0;
+        if (!boundary) {
+            const double h = step[k / samples_per_segment];
+            for (int i = 0; i < 6; ++i) {
+                dq[k][i] = (q[k + 1][i] - q[k - 1][i]) / (2.0 * h);
+                ddq[k][i] = (q[k + 1][i] - 2.0 * q[k][i] + q[k - 1][i]) / (h * h);
+            }
+            continue;
+        }
+        std::array<double, 6> before{}, after{};
+        double diff = 0.0, norm = 0.0;
+        for (int i = 0; i < 6; ++i) {
+            if (k > 0) before[i] = (q[k][i] - q[k - 1][i]) / (s[k] - s[k - 1]);
+            if (k + 1 < n) after[i] = (q[k + 1][i] - q[k][i]) / (s[k + 1] - s[k]);
+        }
+        for (int i = 0; i < 6; ++i) {
+            dq[k][i] = k + 1 < n ? after[i] : before[i];
+            diff = std::max(diff, std::fabs(after[i] - before[i]));
+            norm = std::max(norm, std::max(std::fabs(after[i]), std::fabs(before[i])));
+        }
+        // 共线路点的单边导数只相差离散误差，不需要停
+        if (k > 0 && k + 1 < n && diff > 1e-2 * norm) stop[k] = true;
+    }
+
+    // 在路径点 k、状态 x = ṡ² 下，腿加速度约束 -A ≤ q' u + q'' x ≤ A 给出的 u = s̈ 可行区间
+    auto accel_bounds = [&](size_t k, double x, double& u_min, double& u_max) {
+        u_min = -HUGE_VAL;
+        u_max = HUGE_VAL;
+        for (int i = 0; i < 6; ++i) {
+            const double a = dq[k][i], b = ddq[k][i], A = limits[i].max_acceleration;
+            if (std::fabs(a) < 1e-9) continue;   // 仅约束 x，已计入速度上限曲线
+            double lo = (-A - b * x) / a, hi = (A - b * x) / a;
+            if (a < 0) std::swap(lo, hi);
+            u_min = std::max(u_min, lo);
+            u_max = std::min(u_max, hi);
+        }
+    };
+
+    // 第三步：速度上限曲线 MVC（腿速度约束 + 加速度约束可行）
+    const double x_cap = 1e12;
+    std::vector<double> mvc(n);
+    for (size_t k = 0; k < n; ++k) {
+        if (stop[k]) {
+            mvc[k] = 0.0;
+            continue;
+        }
+        double x_max = x_cap;
+        for (int i = 0; i < 6; ++i) {
+            const double a = std::fabs(dq[k][i]), b = std::fabs(ddq[k][i]);
+            if (a > 1e-9) x_max = std::min(x_max, std::pow(limits[i].max_velocity / a, 2));
+            if (a <= 1e-9 && b > 1e-9) x_max = std::min(x_max, limits[i].max_acceleration / b);
+        }
+        // 加速度可行区间非空的 x 构成 [0, x*]，二分求 x*
+        double u_min, u_max;
+        accel_bounds(k, x_max, u_min, u_max);
+        if (u_min > u_max) {
+            double ok = 0.0, bad = x_max;
+            for (int iter = 0; iter < 60; ++iter) {
+                double mid = 0.5 * (ok + bad);
+                accel_bounds(k, mid, u_min, u_max);
+                if (u_min <= u_max) ok = mid; else bad = mid;
+            }
+            x_max = ok;
+        }
+        mvc[k] = x_max;
+    }
+
+    // 第四步：后向积分（终点静止），以最大减速度可达的上限
+    std::vector<double> x(n);
+    x[n - 1] = 0.0;
+    for (size_t k = n - 1; k-- > 0;) {
+        const double ds = s[k + 1] - s[k];
+        auto reach = [&](double xk) {
+            double u_min, u_max;
+            accel_bounds(k, xk, u_min, u_max);
+            return xk + 2.0 * ds * u_min <= x[k + 1];
+        };
+        if (reach(mvc[k])) {
+            x[k] = mvc[k];
+        } else {
+            double ok = 0.0, bad = mvc[k];
+            for (int iter = 0; iter < 60; ++iter) {
+                double mid = 0.5 * (ok + bad);
+                if (reach(mid)) ok = mid; else bad = mid;
+            }
+            x[k] = ok;
+        }
+    }
+
+    // 第五步：前向积分（起点静止），取最大加速度与后向结果的较小值
+    x[0] = 0.0;
+    for (size_t k = 0; k + 1 < n; ++k) {
+        double u_min, u_max;
+        accel_bounds(k, x[k], u_min, u_max);
+        x[k + 1] = std::max(0.0, std::min(x[k + 1], x[k] + 2.0 * (s[k + 1] - s[k]) * u_max));
+    }
+
+    // 第六步：积分时间，按最小时间间隔输出PVT点（拐点必须输出）
+    double t = 0.0;
+    double last_emit = -HUGE_VAL;
+    bool last_was_stop = false;
+    for (size_t k = 0; k < n; ++k) {
+        if (k > 0) {
+            double denom = std::sqrt(x[k - 1]) + std::sqrt(x[k]);
+            if (denom > 0.0) t += 2.0 * (s[k] - s[k - 1]) / denom;
+        }
+        if (stop[k] || t - last_emit >= sample_interval) {
+            if (stop[k] && !last_was_stop && t - last_emit < 0.5 * sample_interval) {
+                // 拐点离上一个普通输出点太近：替换该点，避免过短的PVT时间间隔
+                table.time.pop_back();
+                for (int i = 0; i < 6; ++i) {
+                    table.position[i].pop_back();
+                    table.velocity[i].pop_back();
+                }
+            }
+            last_was_stop = stop[k];
+            const double sdot = std::sqrt(x[k]);
+            table.time.push_back(t);
+            for (int i = 0; i < 6; ++i) {
+                table.position[i].push_back(q[k][i] - q[0][i]);
+                table.velocity[i].push_back(dq[k][i] * sdot);
+            }
+            last_emit = t;
+        }
+    }
+    return t;
+}
+
 long TrajectoryPlanner::displacementToPulse(double displacement_mm, double pulse_per_mm) {
     return static_cast<long>(displacement_mm * pulse_per_mm);
 }
@@ -0,0 +1,93 @@
+#include "common/poller_pool.h"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace Common {
+
+PollerPool::PollerPool(const std::string &name, size_t max_workers)
+    : name_(name), max_workers_(std::max<size_t>(1, max_workers)) {}
+
+PollerPool::~PollerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &t : workers_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+long PollerPool::add(double rate_hz, std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    long id = next_id_++;
+    Task &t = tasks_[id];
+    t.period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / std::max(rate_hz, 1e-3)));
+    t.next = std::chrono::steady_clock::now();
+    t.fn = std::move(task);
+    if (workers_.size() < std::min(tasks_.size(), max_workers_)) {
+        workers_.emplace_back(&PollerPool::worker_loop, this);
+    }
+    cv_.notify_all();
+    return id;
+}
+
+void PollerPool::remove(long id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = tasks_.find(id);
+    if (it == tasks_.end()) return;
+    it->second.removed = true;
+    cv_.wait(lock, [&] { return !it->second.running; });
+    tasks_.erase(it);
+    cv_.notify_all();
+}
+
+size_t PollerPool::workers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return workers_.size();
+}
+
+void PollerPool::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        // 选出最早到期且未在执行的任务
+        auto due = tasks_.end();
+        for (auto it = tasks_.begin(); it != tasks_.end(); ++it) {
+            if (it->second.running || it->second.removed) continue;
+            if (due == tasks_.end() || it->second.next < due->second.next) due = it;
+        }
+        if (due == tasks_.end()) {
+            cv_.wait(lock);
+            continue;
+        }
+        if (std::chrono::steady_clock::now() < due->second.next) {
+            // 等待期间任务集合可能变化（新增/删除），醒来后重新选择
+            cv_.wait_until(lock, due->second.next);
+            continue;
+        }
+        Task &task = due->second;
+        task.running = true;
+        std::function<void()> fn = task.fn;
+        lock.unlock();
+        try {
+            fn();
+        } catch (const std::exception &e) {
+            std::cerr << "[PollerPool:" << name_ << "] task " << due->first << " threw: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "[PollerPool:" << name_ << "] task " << due->first << " threw unknown exception" << std::endl;
+        }
+        lock.lock();
+        task.running = false;
+        auto now = std::chrono::steady_clock::now();
+        task.next += task.period;
+        if (now > task.next + task.period) {
+            task.next = now;  // 落后超过一个周期时不追赶，避免突发轮询
+        }
+        cv_.notify_all();
+    }
+}
+
+} // namespace Common
@@ -1,5 +1,8 @@
 #include "device_services/motion_controller_device.h"
 #include "common/system_config.h"
+#include "common/kinematics.h"
+#include "common/call_stats.h"
+#include "common/poller_pool.h"
 #include "drivers/LTSMC.h"
 #include <iostream>
 #include <cstdio>
@@ -8,12 +11,101 @@
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
+// 计时包装：按接口名记录每次 SMC 调用的次数、错误数与延迟分布（smcCallStats 属性）。
+// 每个调用点缓存一次直方图引用，之后只做原子计数。SMC_CALL 用于返回错误码的接口，
+// SMC_QUERY 用于返回电平/状态值的接口（不计错误）。
+#define SMC_TIMED(fn, count_errors, ...)                                                      \
+    ([&]() {                                                                                  \
+        static Common::CallHistogram &smc_hist_ = Common::CallStatsRegistry::instance().histogram(#fn); \
+        auto smc_t0_ = std::chrono::steady_clock::now();                                      \
+        auto smc_ret_ = fn(__VA_ARGS__);                                                      \
+        smc_hist_.record(std::chrono::steady_clock::now() - smc_t0_,                          \
+                         (count_errors) && Common::call_failed(smc_ret_));                    \
+        return smc_ret_;                                                                      \
+    }())
+#define SMC_CALL(fn, ...) SMC_TIMED(fn, true, __VA_ARGS__)
+#define SMC_QUERY(fn, ...) SMC_TIMED(fn, false, __VA_ARGS__)
+
 namespace MotionController {
 
+namespace {
+// -1: negative limit, 0: origin, 1: positive limit, 2: none
+double special_location_of(short org, bool pos_lim, bool neg_lim) {
+    if (org == 1) return 0;
+    if (pos_lim) return 1;
+    if (neg_lim) return -1;
+    return 2;
+}
+
+// setPvtsBinary 头部的整数字段：须为不超过 limit 的有限非负整数，否则直接转换为整型是未定义行为
+bool pvt_binary_index(double value, size_t limit, size_t &out) {
+    if (!std::isfinite(value) || value < 0 || value > static_cast<double>(limit) || value != std::floor(value)) {
+        return false;
+    }
+    out = static_cast<size_t>(value);
+    return true;
+}
+
+// 标准序列的 G代码模板（轴 0..5 对应 X Y Z A B C），G28 按控制器已配置的回零参数回零
+const char *SCRIPT_PARK =
+    "G90\n"
+    "G01 X${x} Y${y} Z${z} A${a} B${b} C${c} F${feed}\n"
+    "M30\n";
+const char *SCRIPT_BACKOFF_PARK =
+    "G91\n"
+    "G01 X${bx} Y${by} Z${bz} A${ba} B${bb} C${bc} F${feed}\n"
+    "G90\n"
+    "G01 X${x} Y${y} Z${z} A${a} B${b} C${c} F${feed}\n"
+    "M30\n";
+const char *SCRIPT_HOME_BACKOFF_PARK =
+    "G28 X0 Y0 Z0 A0 B0 C0\n"
+    "G91\n"
+    "G01 X${bx} Y${by} Z${bz} A${ba} B${bb} C${bc} F${feed}\n"
+    "G90\n"
+    "G01 X${x} Y${y} Z${z} A${a} B${b} C${c} F${feed}\n"
+    "M30\n";
+
+// 同一进程可承载多个控制器设备：轮询与事件任务共用线程池，card_id（smc_board_init 连接号）
+// 在进程内必须唯一。SMC 接口调用统计（CallStatsRegistry）同样为进程级，各卡合并统计。
+Common::PollerPool &hardware_poller_pool() {
+    static Common::PollerPool pool("hardware", 8);   // 同一卡的调用在连接上串行，每卡一个线程即可
+    return pool;
+}
+
+Common::PollerPool &event_poller_pool() {
+    static Common::PollerPool pool("events", 2);
+    return pool;
+}
+
+std::mutex g_card_owners_mutex;
+std::map<int, std::string> g_card_owners;
+
+// 登记 card_id 的使用者，已被其他设备占用时返回占用者名称
+std::string claim_card(int card_id, const std::string &device) {
+    std::lock_guard<std::mutex> lock(g_card_owners_mutex);
+    auto it = g_card_owners.find(card_id);
+    if (it != g_card_owners.end() && it->second != device) return it->second;
+    g_card_owners[card_id] = device;
+    return "";
+}
+
+void release_card(int card_id, const std::string &device) {
+    std::lock_guard<std::mutex> lock(g_card_owners_mutex);
+    auto it = g_card_owners.find(card_id);
+    if (it != g_card_owners.end() && it->second == device) g_card_owners.erase(it);
+}
+
+// smc_download_memfile 文件类型
+const unsigned short SCRIPT_FILETYPE_BASIC = 0;
+const unsigned short SCRIPT_FILETYPE_GCODE = 1;
+}  // namespace
+
 MotionControllerDevice::MotionControllerDevice(Tango::DeviceClass *cl, std::string &name)
     : Tango::Device_4Impl(cl, name.c_str()),
       self_check_result_(-1),
@@ -100,6 +192,9 @@ void MotionControllerDevice::init_device() {
     INFO_STREAM << "MotionControllerDevice::init_device() " << get_name() << std::endl;
     set_state(Tango::INIT);
 
+    pvt_stream_crd_ = 0;
+    pvt_stream_closing_ = false;
+
     // Get all properties
     Tango::DbData db_data;
     // Standard properties
@@ -126,6 +221,10 @@ void MotionControllerDevice::init_device() {
     // Connection properties
     db_data.push_back(Tango::DbDatum("controller_ip"));
     db_data.push_back(Tango::DbDatum("card_id"));
+    db_data.push_back(Tango::DbDatum("pvtReduceTolerance"));
+    db_data.push_back(Tango::DbDatum("pollRateHz"));
+    db_data.push_back(Tango::DbDatum("eventDeadbands"));
+    db_data.push_back(Tango::DbDatum("scriptTemplates"));
     
     get_db_device()->get_property(db_data);
 
@@ -171,6 +270,60 @@ void MotionControllerDevice::init_device() {
     if (!db_data[idx].is_empty()) { db_data[idx] >> controller_ip_; } else { controller_ip_ = "192.168.0.11"; }
     idx++;
     if (!db_data[idx].is_empty()) { db_data[idx] >> card_id_; }
+    idx++;
+    if (!db_data[idx].is_empty()) { db_data[idx] >> pvt_reduce_tolerance_; } else { pvt_reduce_tolerance_ = 0.001; }
+    idx++;
+    if (!db_data[idx].is_empty()) { db_data[idx] >> poll_rate_hz_; } else { poll_rate_hz_ = 50.0; }
+    poll_rate_hz_ = std::max(1.0, std::min(poll_rate_hz_, 1000.0));
+    idx++;
+    if (!db_data[idx].is_empty()) { db_data[idx] >> event_deadbands_prop_; }
+    idx++;
+    if (!db_data[idx].is_empty()) { db_data[idx] >> script_templates_prop_; }
+
+    // 事件死区：默认位置 0.001、模拟量 0.01，离散量任意变化即推送
+    event_deadbands_.clear();
+    event_deadbands_["motorPos"].abs_change = 0.001;
+    event_deadbands_["analogInValue"].abs_change = 0.01;
+    if (!event_deadbands_prop_.empty()) {
+        try {
+            json j = json::parse(event_deadbands_prop_);
+            for (auto it = j.begin(); it != j.end(); ++it) {
+                EventDeadband &db = event_deadbands_[it.key()];
+                db.abs_change = it.value().value("abs", db.abs_change);
+                db.rel_change = it.value().value("rel", db.rel_change);
+            }
+        } catch (const std::exception &e) {
+            WARN_STREAM << "eventDeadbands 解析失败, 使用默认死区: " << e.what() << std::endl;
+        }
+    }
+
+    // 脚本模板库：内置标准序列，scriptTemplates 属性可增加或覆盖
+    std::map<std::string, std::string> park_defaults = {
+        {"x", "0"}, {"y", "0"}, {"z", "0"}, {"a", "0"}, {"b", "0"}, {"c", "0"}, {"feed", "600"}};
+    std::map<std::string, std::string> backoff_defaults = park_defaults;
+    for (const char *key : {"bx", "by", "bz", "ba", "bb", "bc"}) backoff_defaults[key] = "0";
+    script_templates_.clear();
+    script_templates_["park"] = {"gcode", SCRIPT_PARK, park_defaults};
+    script_templates_["backoffPark"] = {"gcode", SCRIPT_BACKOFF_PARK, backoff_defaults};
+    script_templates_["homeBackoffPark"] = {"gcode", SCRIPT_HOME_BACKOFF_PARK, backoff_defaults};
+    if (!script_templates_prop_.empty()) {
+        try {
+            json j = json::parse(script_templates_prop_);
+            for (auto it = j.begin(); it != j.end(); ++it) {
+                ScriptTemplate tpl;
+                tpl.type = it.value().value("type", std::string("gcode"));
+                tpl.text = it.value().at("text").get<std::string>();
+                if (it.value().count("defaults")) {
+                    for (auto d = it.value()["defaults"].begin(); d != it.value()["defaults"].end(); ++d) {
+                        tpl.defaults[d.key()] = d.value().is_string() ? d.value().get<std::string>() : d.value().dump();
+                    }
+                }
+                script_templates_[it.key()] = tpl;
+            }
+        } catch (const std::exception &e) {
+            WARN_STREAM << "scriptTemplates 解析失败, 仅使用内置模板: " << e.what() << std::endl;
+        }
+    }
 
     // Initialize attribute caches
     struct_parameter_attr_ = struct_parameter_prop_;
@@ -192,11 +345,21 @@ void MotionControllerDevice::init_device() {
         INFO_STREAM << "[DEBUG] 运行模式: 真实模式 (从配置文件加载, SIM_MODE=false)" << std::endl;
         INFO_STREAM << "[DEBUG] 提示: 可通过 simSwitch 命令或GUI动态切换模拟模式" << std::endl;
         
-        // Connect to hardware
-        DEBUG_STREAM << "[SMC] smc_board_init(card_id=" << card_id_ << ", ip=" << controller_ip_ << ")" << std::endl;
-        short ret = smc_board_init(card_id_, 2, const_cast<char*>(controller_ip_.c_str()), 0);
-        DEBUG_STREAM << "[SMC] smc_board_init() returned: " << ret << std::endl;
-        if (ret != 0) {
+        // Connect to hardware（同进程内的其他设备已占用该 card_id 时不打开板卡）
+        std::string owner = claim_card(card_id_, get_name());
+        short ret = 0;
+        if (owner.empty()) {
+            DEBUG_STREAM << "[SMC] smc_board_init(card_id=" << card_id_ << ", ip=" << controller_ip_ << ")" << std::endl;
+            ret = SMC_CALL(smc_board_init, card_id_, 2, const_cast<char*>(controller_ip_.c_str()), 0);
+            DEBUG_STREAM << "[SMC] smc_board_init() returned: " << ret << std::endl;
+        }
+        if (!owner.empty()) {
+            ERROR_STREAM << "MotionControllerDevice: card_id " << card_id_ << " already used by " << owner << std::endl;
+            set_state(Tango::FAULT);
+            set_status("card_id " + std::to_string(card_id_) + " already used by " + owner + " in this process");
+            is_connected_ = false;
+            log_event("card_id " + std::to_string(card_id_) + " conflicts with " + owner);
+        } else if (ret != 0) {
             ERROR_STREAM << "MotionControllerDevice: Failed to init board. Ret=" << ret << std::endl;
             set_state(Tango::FAULT);
             set_status("Hardware initialization failed");
@@ -210,16 +373,35 @@ void MotionControllerDevice::init_device() {
         }
     }
     
+    start_poller();
+    start_async_workers();
+    
     INFO_STREAM << "MotionControllerDevice::init_device() completed for " << get_name() 
               << " [State: " << Tango::DevStateName[get_state()] << "]" << std::endl;
 }
 
 void MotionControllerDevice::delete_device() {
+    stop_async_workers();
+    stop_pvt_stream(!sim_mode_ && is_connected_);
+    if (conti_open_ && !sim_mode_ && is_connected_) {
+        SMC_CALL(smc_conti_stop_list, card_id_, conti_crd_, 0);
+        conti_open_ = false;
+    }
+    conti_poll_crd_ = -1;
+    if (!script_type_.empty() && !sim_mode_ && is_connected_) {
+        if (script_type_ == "basic") SMC_CALL(smc_basic_stop, card_id_);
+        else SMC_CALL(smc_gcode_stop, card_id_);
+    }
+    script_running_ = false;
+    script_paused_ = false;
+    script_poll_kind_ = 0;
+    stop_poller();
     if (is_connected_) {
         DEBUG_STREAM << "[SMC] smc_board_close(card_id=" << card_id_ << ")" << std::endl;
-        smc_board_close(card_id_);
+        SMC_CALL(smc_board_close, card_id_);
         DEBUG_STREAM << "[SMC] smc_board_close() completed" << std::endl;
     }
+    release_card(card_id_, get_name());
 }
 
 void MotionControllerDevice::check_connection() {
@@ -250,11 +432,114 @@ void MotionControllerDevice::log_event(const std::string &event) {
     }
 }
 
+// ========== Change/archive events ==========
+bool MotionControllerDevice::exceeds_deadband(const std::string &attr_name, const double *last,
+                                              const double *value, size_t n) const {
+    EventDeadband db;
+    auto it = event_deadbands_.find(attr_name);
+    if (it != event_deadbands_.end()) db = it->second;
+    for (size_t i = 0; i < n; ++i) {
+        double delta = std::fabs(value[i] - last[i]);
+        if (db.abs_change <= 0.0 && db.rel_change <= 0.0) {
+            if (delta > 0.0) return true;
+            continue;
+        }
+        if (db.abs_change > 0.0 && delta >= db.abs_change) return true;
+        if (db.rel_change > 0.0 && delta >= db.rel_change * std::fabs(last[i])) return true;
+    }
+    return false;
+}
+
+void MotionControllerDevice::event_cycle() {
+    auto now = std::chrono::steady_clock::now();
+    double window_s = std::chrono::duration<double>(now - ev_window_start_).count();
+    if (window_s >= 1.0) {
+        event_rate_ = ev_window_events_ / window_s;
+        ev_window_events_ = 0;
+        ev_window_start_ = now;
+    }
+    
+    if (async_dirty_.exchange(false)) {
+        std::string queue_json = async_queue_json();
+        try {
+            Tango::AutoTangoMonitor synch(this);
+            Tango::DevString val = const_cast<char*>(queue_json.c_str());
+            push_change_event("commandQueue", &val);
+            ev_window_events_ += 1;
+        } catch (Tango::DevFailed &e) {
+            ERROR_STREAM << "[Events] 推送 commandQueue 事件失败: " << e.errors[0].desc.in() << std::endl;
+        }
+    }
+    
+    uint64_t version = snapshot_version_.load(std::memory_order_acquire);
+    if (sim_mode_ || version == ev_last_version_) return;
+    ev_last_version_ = version;
+    HardwareSnapshot snap;
+    if (!read_snapshot(snap) || !snap.valid) {
+        ev_primed_ = false;
+        return;
+    }
+    
+    std::array<Tango::DevBoolean, MAX_AXES> axis_status;
+    std::array<double, MAX_AXES> special;
+    for (int i = 0; i < MAX_AXES; i++) {
+        axis_status[i] = !snap.done[i];
+        special[i] = special_location_of(snap.org[i], snap.el_pos[i], snap.el_neg[i]);
+    }
+    bool push_pos = !ev_primed_ || exceeds_deadband("motorPos", ev_motor_pos_.data(), snap.position.data(), MAX_AXES);
+    bool push_status = !ev_primed_ || axis_status != ev_axis_status_;
+    bool push_io = !ev_primed_ || exceeds_deadband("genericIoInputValue", ev_io_.data(), snap.inputs.data(), MAX_IO_CHANNELS);
+    bool push_special = !ev_primed_ || exceeds_deadband("specialLocationValue", ev_special_.data(), special.data(), MAX_AXES);
+    bool push_ain = !ev_primed_ || exceeds_deadband("analogInValue", ev_ain_.data(), snap.ain.data(), MAX_AD_CHANNELS);
+    if (!(push_pos || push_status || push_io || push_special || push_ain)) return;
+    
+    try {
+        // 非 Tango 线程推送事件需持有设备监视器
+        Tango::AutoTangoMonitor synch(this);
+        if (push_pos) {
+            ev_motor_pos_ = snap.position;
+            push_change_event("motorPos", ev_motor_pos_.data(), MAX_AXES);
+            push_archive_event("motorPos", ev_motor_pos_.data(), MAX_AXES);
+            ev_window_events_ += 2;
+        }
+        if (push_status) {
+            ev_axis_status_ = axis_status;
+            push_change_event("axisStatus", ev_axis_status_.data(), MAX_AXES);
+            push_archive_event("axisStatus", ev_axis_status_.data(), MAX_AXES);
+            ev_window_events_ += 2;
+        }
+        if (push_io) {
+            ev_io_ = snap.inputs;
+            push_change_event("genericIoInputValue", ev_io_.data(), MAX_IO_CHANNELS);
+            push_archive_event("genericIoInputValue", ev_io_.data(), MAX_IO_CHANNELS);
+            ev_window_events_ += 2;
+        }
+        if (push_special) {
+            ev_special_ = special;
+            push_change_event("specialLocationValue", ev_special_.data(), MAX_AXES);
+            push_archive_event("specialLocationValue", ev_special_.data(), MAX_AXES);
+            ev_window_events_ += 2;
+        }
+        if (push_ain) {
+            ev_ain_ = snap.ain;
+            push_change_event("analogInValue", ev_ain_.data(), MAX_AD_CHANNELS);
+            push_archive_event("analogInValue", ev_ain_.data(), MAX_AD_CHANNELS);
+            ev_window_events_ += 2;
+        }
+        ev_primed_ = true;
+    } catch (Tango::DevFailed &e) {
+        ERROR_STREAM << "[Events] 推送事件失败: " << e.errors[0].desc.in() << std::endl;
+    }
+}
+
 // ========== Reconnection mechanism ==========
 bool MotionControllerDevice::try_reconnect() {
     if (sim_mode_ || is_connected_ || reconnect_in_progress_) {
         return is_connected_;
     }
+    if (!claim_card(card_id_, get_name()).empty()) {
+        return false;  // card_id 被同进程其他设备占用，重连无意义
+    }
     
     // 检查重连间隔
     auto now = std::chrono::steady_clock::now();
@@ -279,14 +564,19 @@ bool MotionControllerDevice::try_reconnect() {
     INFO_STREAM << "[Reconnect] 尝试重连控制器 (第 " << reconnect_attempts_ << " 次)..." << std::endl;
     log_event("Attempting reconnection (attempt " + std::to_string(reconnect_attempts_) + ")");
     
-    // 先关闭旧连接（如果有）
-    DEBUG_STREAM << "[SMC] smc_board_close(card_id=" << card_id_ << ") [reconnect cleanup]" << std::endl;
-    smc_board_close(card_id_);
-    
-    // 尝试重新连接
-    DEBUG_STREAM << "[SMC] smc_board_init(card_id=" << card_id_ << ", ip=" << controller_ip_ << ") [reconnect]" << std::endl;
-    short ret = smc_board_init(card_id_, 2, const_cast<char*>(controller_ip_.c_str()), 0);
-    DEBUG_STREAM << "[SMC] smc_board_init() returned: " << ret << std::endl;
+    short ret = 0;
+    {
+        std::lock_guard<std::mutex> poll_lock(hw_poll_mutex_);
+        // 先关闭旧连接（如果有）
+        DEBUG_STREAM << "[SMC] smc_board_close(card_id=" << card_id_ << ") [reconnect cleanup]" << std::endl;
+        SMC_CALL(smc_board_close, card_id_);
+        
+        // 尝试重新连接
+        DEBUG_STREAM << "[SMC] smc_board_init(card_id=" << card_id_ << ", ip=" << controller_ip_ << ") [reconnect]" << std::endl;
+        ret = SMC_CALL(smc_board_init, card_id_, 2, const_cast<char*>(controller_ip_.c_str()), 0);
+        DEBUG_STREAM << "[SMC] smc_board_init() returned: " << ret << std::endl;
+        invalidate_snapshot();
+    }
     
     reconnect_in_progress_ = false;
     
@@ -317,16 +607,16 @@ bool MotionControllerDevice::check_connection_health() {
         return false;
     }
     
-    // 尝试读取一个轴的位置来验证连接是否正常
-    double pos = 0.0;
-    DEBUG_STREAM << "[SMC] smc_get_position_unit(card_id=" << card_id_ << ", axis=0) [health check]" << std::endl;
-    short ret = smc_get_position_unit(card_id_, 0, &pos);
-    DEBUG_STREAM << "[SMC] smc_get_position_unit() returned: " << ret << " [health check]" << std::endl;
+    // 由轮询线程在每个周期读取0轴位置，这里只检查最近一次结果
+    HardwareSnapshot snap;
+    if (!read_snapshot(snap) || !snap.valid) {
+        return true;  // 尚无快照（刚连接），下次再判定
+    }
     
-    if (ret != 0) {
+    if (!snap.link_ok) {
         // 连接可能已断开
-        WARN_STREAM << "[HealthCheck] 连接健康检查失败, 错误码: " << ret << std::endl;
-        log_event("Connection health check failed with error code " + std::to_string(ret));
+        WARN_STREAM << "[HealthCheck] 连接健康检查失败: 轮询线程读取位置失败" << std::endl;
+        log_event("Connection health check failed: poller position read failed");
         is_connected_ = false;
         set_state(Tango::FAULT);
         set_status("Connection lost - health check failed");
@@ -338,12 +628,9 @@ bool MotionControllerDevice::check_connection_health() {
 
 void MotionControllerDevice::update_motor_positions() {
     if (sim_mode_) return;
-    for (int i = 0; i < MAX_AXES; i++) {
-        double pos = 0.0;
-        DEBUG_STREAM << "[SMC] smc_get_position_unit(card_id=" << card_id_ << ", axis=" << i << ")" << std::endl;
-        smc_get_position_unit(card_id_, i, &pos);
-        DEBUG_STREAM << "[SMC] smc_get_position_unit() returned pos=" << pos << std::endl;
-        motor_pos_[i] = pos;
+    HardwareSnapshot snap;
+    if (read_snapshot(snap) && snap.valid) {
+        motor_pos_ = snap.position;
     }
 }
 
@@ -354,12 +641,139 @@ void MotionControllerDevice::update_axis_status() {
         // But here we just return to avoid hardware calls.
         return;
     }
+    HardwareSnapshot snap;
+    if (!read_snapshot(snap) || !snap.valid) return;
+    for (int i = 0; i < MAX_AXES; i++) {
+        axis_status_[i] = !snap.done[i];  // smc_check_done 0=运动中 -> axis_status_ = true 表示正在运动
+    }
+}
+
+// ========== Background hardware poller ==========
+void MotionControllerDevice::start_poller() {
+    stop_poller();
+    poll_cycle_count_ = 0;
+    ev_last_version_ = 0;
+    ev_primed_ = false;
+    ev_window_events_ = 0;
+    ev_window_start_ = std::chrono::steady_clock::now();
+    poll_task_id_ = hardware_poller_pool().add(poll_rate_hz_, [this] { poll_cycle(); });
+    event_task_id_ = event_poller_pool().add(poll_rate_hz_, [this] { event_cycle(); });
+    INFO_STREAM << "[Poller] 已注册到共享轮询线程池, 频率 " << poll_rate_hz_ << " Hz, card_id " << card_id_
+                << ", 轮询线程数 " << hardware_poller_pool().workers() << std::endl;
+}
+
+void MotionControllerDevice::stop_poller() {
+    if (poll_task_id_) {
+        hardware_poller_pool().remove(poll_task_id_);
+        poll_task_id_ = 0;
+    }
+    if (event_task_id_) {
+        event_poller_pool().remove(event_task_id_);
+        event_task_id_ = 0;
+    }
+}
+
+bool MotionControllerDevice::read_snapshot(HardwareSnapshot &out) const {
+    // 快照发布后不再修改，持有指针期间即使轮询线程发布了新快照也不会被覆盖
+    std::shared_ptr<const HardwareSnapshot> snap = std::atomic_load(&snapshot_);
+    if (!snap) return false;
+    out = *snap;
+    return true;
+}
+
+void MotionControllerDevice::publish_snapshot(std::shared_ptr<const HardwareSnapshot> snap) {
+    // 调用方持有 hw_poll_mutex_
+    std::atomic_store(&snapshot_, std::move(snap));
+    snapshot_version_.fetch_add(1, std::memory_order_release);
+}
+
+void MotionControllerDevice::invalidate_snapshot() {
+    // 调用方持有 hw_poll_mutex_；断线前的快照（link_ok=false）作废，等待轮询线程重新采集
+    publish_snapshot(std::make_shared<const HardwareSnapshot>());
+}
+
+void MotionControllerDevice::note_motion_command() {
+    // 运动指令下发时可能恰有一个轮询周期在进行，其 done 标志早于指令；
+    // 再往后一个周期的快照才能反映本次运动
+    motion_snapshot_barrier_ = snapshot_version_.load() + 2;
+}
+
+// 一个轮询周期，由共享线程池按 pollRateHz 调度
+void MotionControllerDevice::poll_cycle() {
+    if (!is_connected_ || sim_mode_) return;
+    std::lock_guard<std::mutex> lock(hw_poll_mutex_);
+    std::shared_ptr<const HardwareSnapshot> prev = std::atomic_load(&snapshot_);
+    auto next = prev ? std::make_shared<HardwareSnapshot>(*prev)   // 慢速组沿用上一周期的值
+                     : std::make_shared<HardwareSnapshot>();
+    HardwareSnapshot &snap = *next;
+    bool slow = !snap.valid || (poll_cycle_count_ % POLL_SLOW_DIVIDER) == 0;
+    auto cycle_start = std::chrono::steady_clock::now();
+    
+    // 快速组：位置、运动完成、轴IO状态（含限位位）。带错误码的读取任一失败即视为链路异常
+    snap.link_ok = true;
     for (int i = 0; i < MAX_AXES; i++) {
-        DEBUG_STREAM << "[SMC] smc_check_done(card_id=" << card_id_ << ", axis=" << i << ")" << std::endl;
-        short state = smc_check_done(card_id_, i);
-        // smc_check_done 返回值: 0=运动中, 1=已停止
-        DEBUG_STREAM << "[SMC] smc_check_done() returned: " << state << " (0=moving, 1=stopped)" << std::endl;
-        axis_status_[i] = (state == 0);  // 0 = 运动中 -> axis_status_ = true 表示正在运动
+        double pos = 0.0;
+        if (SMC_CALL(smc_get_position_unit, card_id_, i, &pos) == 0) {
+            snap.position[i] = pos;
+        } else {
+            snap.link_ok = false;
+        }
+        snap.done[i] = (SMC_QUERY(smc_check_done, card_id_, i) != 0);
+        DWORD io = SMC_QUERY(smc_axis_io_status, card_id_, i);
+        snap.el_pos[i] = (io & 0x01) != 0;
+        snap.el_neg[i] = (io & 0x02) != 0;
+    }
+    int conti_crd = conti_poll_crd_.load();
+    snap.conti_crd = conti_crd;
+    snap.conti_run_state = (conti_crd >= 0) ? SMC_QUERY(smc_conti_get_run_state, card_id_, conti_crd) : -1;
+    int script_kind = script_poll_kind_.load();
+    snap.script_kind = script_kind;
+    if (script_kind != 0) {
+        WORD script_state = 0;
+        short ret = (script_kind == 1) ? SMC_QUERY(smc_basic_state, card_id_, &script_state)
+                                       : SMC_QUERY(smc_gcode_state, card_id_, &script_state);
+        snap.script_state = (ret == 0) ? static_cast<int>(script_state) : -1;
+    }
+    
+    // 慢速组：原点/伺服使能、通用输入、模拟量输入
+    if (slow) {
+        for (int i = 0; i < MAX_AXES; i++) {
+            WORD org = 1, servo = 1;
+            if (SMC_CALL(smc_read_org_pin_ex, card_id_, i, &org) != 0 ||
+                SMC_CALL(smc_read_sevon_pin_ex, card_id_, i, &servo) != 0) {
+                snap.link_ok = false;
+            }
+            snap.org[i] = static_cast<short>(org);
+            snap.servo_on[i] = static_cast<short>(servo);
+        }
+        for (int i = 0; i < MAX_IO_CHANNELS; i++) {
+            DWORD state = 0;
+            if (SMC_CALL(smc_read_inport_ex, card_id_, i, &state) == 0) {
+                snap.inputs[i] = state;
+            } else {
+                snap.link_ok = false;
+            }
+        }
+        for (int i = 0; i < MAX_AD_CHANNELS; i++) {
+            snap.ain[i] = SMC_QUERY(smc_get_ain, card_id_, i);
+        }
+        snap.valid = true;
+    }
+    auto stamp = std::chrono::steady_clock::now();
+    snap.stamp = stamp;
+    publish_snapshot(std::move(next));
+    poll_cycle_count_++;
+    
+    // 周期超时时线程池不补跑错过的周期，实际频率低于 pollRateHz；至多每10秒记录一次
+    double elapsed = std::chrono::duration<double>(stamp - cycle_start).count();
+    if (elapsed > 1.0 / poll_rate_hz_) {
+        poll_overruns_++;
+        if (stamp - poll_overrun_logged_ > std::chrono::seconds(10)) {
+            poll_overrun_logged_ = stamp;
+            WARN_STREAM << "[Poller] card_id " << card_id_ << " 轮询周期耗时 " << elapsed * 1000.0
+                        << " ms 超过 pollRateHz=" << poll_rate_hz_ << " 的周期, 累计超时 " << poll_overruns_
+                        << " 次" << std::endl;
+        }
     }
 }
 
@@ -426,7 +840,7 @@ void MotionControllerDevice::selfCheck() {
             // Simple check - try to read position
             double pos;
             DEBUG_STREAM << "[SMC] smc_get_position_unit(card_id=" << card_id_ << ", axis=" << i << ") [selfCheck]" << std::endl;
-            short ret = smc_get_position_unit(card_id_, i, &pos);
+            short ret = SMC_CALL(smc_get_position_unit, card_id_, i, &pos);
             DEBUG_STREAM << "[SMC] smc_get_position_unit() returned: " << ret << ", pos=" << pos << std::endl;
             if (ret != 0) {
                 self_check_result_ = 1;  // Motor error
@@ -460,9 +874,19 @@ void MotionControllerDevice::connect() {
         return;
     }
 
-    DEBUG_STREAM << "[SMC] smc_board_init(card_id=" << card_id_ << ", ip=" << controller_ip_ << ") [connect]" << std::endl;
-    short ret = smc_board_init(card_id_, 2, const_cast<char*>(controller_ip_.c_str()), 0);
-    DEBUG_STREAM << "[SMC] smc_board_init() returned: " << ret << std::endl;
+    std::string owner = claim_card(card_id_, get_name());
+    if (!owner.empty()) {
+        Tango::Except::throw_exception("CardInUse",
+            "card_id " + std::to_string(card_id_) + " already used by " + owner + " in this process", "connect");
+    }
+    short ret = 0;
+    {
+        std::lock_guard<std::mutex> poll_lock(hw_poll_mutex_);
+        DEBUG_STREAM << "[SMC] smc_board_init(card_id=" << card_id_ << ", ip=" << controller_ip_ << ") [connect]" << std::endl;
+        ret = SMC_CALL(smc_board_init, card_id_, 2, const_cast<char*>(controller_ip_.c_str()), 0);
+        DEBUG_STREAM << "[SMC] smc_board_init() returned: " << ret << std::endl;
+        invalidate_snapshot();
+    }
     check_error(ret, "connect");
     is_connected_ = true;
     is_disabled_ = false;
@@ -501,10 +925,13 @@ void MotionControllerDevice::disconnect() {
         return;
     }
 
-    DEBUG_STREAM << "[SMC] smc_board_close(card_id=" << card_id_ << ") [disconnect]" << std::endl;
-    smc_board_close(card_id_);
-    DEBUG_STREAM << "[SMC] smc_board_close() completed" << std::endl;
-    is_connected_ = false;
+    {
+        std::lock_guard<std::mutex> poll_lock(hw_poll_mutex_);
+        is_connected_ = false;
+        DEBUG_STREAM << "[SMC] smc_board_close(card_id=" << card_id_ << ") [disconnect]" << std::endl;
+        SMC_CALL(smc_board_close, card_id_);
+        DEBUG_STREAM << "[SMC] smc_board_close() completed" << std::endl;
+    }
     set_state(Tango::OFF);
     set_status("Disconnected");
     log_event("Controller disconnected");
@@ -528,12 +955,12 @@ void MotionControllerDevice::reset(Tango::DevShort axis_id) {
     }
     
     DEBUG_STREAM << "[SMC] smc_emg_stop(card_id=" << card_id_ << ")" << std::endl;
-    short ret = smc_emg_stop(card_id_);
+    short ret = SMC_CALL(smc_emg_stop, card_id_);
     DEBUG_STREAM << "[SMC] smc_emg_stop() returned: " << ret << std::endl;
     check_error(ret, "reset");
     // Clear error status
     DEBUG_STREAM << "[SMC] smc_clear_stop_reason(card_id=" << card_id_ << ", axis=" << axis_id << ")" << std::endl;
-    ret = smc_clear_stop_reason(card_id_, axis_id);
+    ret = SMC_CALL(smc_clear_stop_reason, card_id_, axis_id);
     DEBUG_STREAM << "[SMC] smc_clear_stop_reason() returned: " << ret << std::endl;
     check_error(ret, "reset_clear_stop_reason");
     
@@ -564,6 +991,7 @@ void MotionControllerDevice::moveZero(Tango::DevShort axis_id) {
     if (is_disabled_) {
         Tango::Except::throw_exception("DISABLED", "Motion disabled by interlock", "moveZero");
     }
+    check_script_idle("moveZero");
     if (get_state() == Tango::FAULT) {
         Tango::Except::throw_exception("FAULT", "Device in fault state, reset required", "moveZero");
     }
@@ -580,6 +1008,7 @@ void MotionControllerDevice::moveZero(Tango::DevShort axis_id) {
     }
     {
         std::lock_guard<std::mutex> lock(state_mutex_);
+        note_motion_command();
         moving_axes_.insert(axis_id);
         set_state(Tango::MOVING);
         set_status("Moving - Home axis " + std::to_string(axis_id));
@@ -587,12 +1016,12 @@ void MotionControllerDevice::moveZero(Tango::DevShort axis_id) {
     
     // 自动检查并使能电机（如果未使能）
     DEBUG_STREAM << "[SMC] Checking axis " << axis_id << " enable status..." << std::endl;
-    short sevon_status = smc_read_sevon_pin(card_id_, axis_id);
+    short sevon_status = SMC_QUERY(smc_read_sevon_pin, card_id_, axis_id);
     DEBUG_STREAM << "[SMC] smc_read_sevon_pin() returned: " << sevon_status << " (0=disabled, 1=enabled)" << std::endl;
     if (sevon_status == 0) {  // 0 = 未使能
         WARN_STREAM << "[SMC] Axis " << axis_id << " is not enabled, auto-enabling..." << std::endl;
         DEBUG_STREAM << "[SMC] smc_write_sevon_pin(card_id=" << card_id_ << ", axis=" << axis_id << ", on_off=1)" << std::endl;
-        short enable_ret = smc_write_sevon_pin(card_id_, axis_id, 1);
+        short enable_ret = SMC_CALL(smc_write_sevon_pin, card_id_, axis_id, 1);
         DEBUG_STREAM << "[SMC] smc_write_sevon_pin() returned: " << enable_ret << std::endl;
         if (enable_ret != 0) {
             WARN_STREAM << "[SMC] Failed to enable axis " << axis_id << ", error code: " << enable_ret 
@@ -603,7 +1032,7 @@ void MotionControllerDevice::moveZero(Tango::DevShort axis_id) {
     }
     
     DEBUG_STREAM << "[SMC] smc_home_move(card_id=" << card_id_ << ", axis=" << axis_id << ")" << std::endl;
-    short ret = smc_home_move(card_id_, axis_id);
+    short ret = SMC_CALL(smc_home_move, card_id_, axis_id);
     DEBUG_STREAM << "[SMC] smc_home_move() returned: " << ret << std::endl;
     if (ret != 0) {
         std::lock_guard<std::mutex> lock(state_mutex_);
@@ -625,6 +1054,7 @@ void MotionControllerDevice::moveRelative(const Tango::DevVarDoubleArray *argin)
     if (is_disabled_) {
         Tango::Except::throw_exception("DISABLED", "Motion disabled by interlock", "moveRelative");
     }
+    check_script_idle("moveRelative");
 
     if (sim_mode_) {
         motor_pos_[axis] += dist;
@@ -637,6 +1067,7 @@ void MotionControllerDevice::moveRelative(const Tango::DevVarDoubleArray *argin)
     
     {
         std::lock_guard<std::mutex> lock(state_mutex_);
+        note_motion_command();
         moving_axes_.insert(axis);
         set_state(Tango::MOVING);
         set_status("Moving - Relative axis " + std::to_string(axis));
@@ -644,12 +1075,12 @@ void MotionControllerDevice::moveRelative(const Tango::DevVarDoubleArray *argin)
     
     // 自动检查并使能电机（如果未使能）
     DEBUG_STREAM << "[SMC] Checking axis " << axis << " enable status..." << std::endl;
-    short sevon_status = smc_read_sevon_pin(card_id_, axis);
+    short sevon_status = SMC_QUERY(smc_read_sevon_pin, card_id_, axis);
     DEBUG_STREAM << "[SMC] smc_read_sevon_pin() returned: " << sevon_status << " (0=disabled, 1=enabled)" << std::endl;
     if (sevon_status == 0) {  // 0 = 未使能
         WARN_STREAM << "[SMC] Axis " << axis << " is not enabled, auto-enabling..." << std::endl;
         DEBUG_STREAM << "[SMC] smc_write_sevon_pin(card_id=" << card_id_ << ", axis=" << axis << ", on_off=1)" << std::endl;
-        short enable_ret = smc_write_sevon_pin(card_id_, axis, 1);
+        short enable_ret = SMC_CALL(smc_write_sevon_pin, card_id_, axis, 1);
         DEBUG_STREAM << "[SMC] smc_write_sevon_pin() returned: " << enable_ret << std::endl;
         if (enable_ret != 0) {
             WARN_STREAM << "[SMC] Failed to enable axis " << axis << ", error code: " << enable_ret 
@@ -660,7 +1091,7 @@ void MotionControllerDevice::moveRelative(const Tango::DevVarDoubleArray *argin)
     }
     
     DEBUG_STREAM << "[SMC] smc_pmove_unit(card_id=" << card_id_ << ", axis=" << axis << ", dist=" << dist << ", mode=relative)" << std::endl;
-    short ret = smc_pmove_unit(card_id_, axis, dist, 0);  // 0 = relative
+    short ret = SMC_CALL(smc_pmove_unit, card_id_, axis, dist, 0);  // 0 = relative
     DEBUG_STREAM << "[SMC] smc_pmove_unit() returned: " << ret << std::endl;
     if (ret != 0) {
         std::lock_guard<std::mutex> lock(state_mutex_);
@@ -682,6 +1113,7 @@ void MotionControllerDevice::moveAbsolute(const Tango::DevVarDoubleArray *argin)
     if (is_disabled_) {
         Tango::Except::throw_exception("DISABLED", "Motion disabled by interlock", "moveAbsolute");
     }
+    check_script_idle("moveAbsolute");
     if (get_state() == Tango::FAULT) {
         Tango::Except::throw_exception("FAULT", "Device in fault state, reset required", "moveAbsolute");
     }
@@ -694,6 +1126,7 @@ void MotionControllerDevice::moveAbsolute(const Tango::DevVarDoubleArray *argin)
     }
     {
         std::lock_guard<std::mutex> lock(state_mutex_);
+        note_motion_command();
         moving_axes_.insert(axis);
         set_state(Tango::MOVING);
         set_status("Moving - Absolute axis " + std::to_string(axis) + " to " + std::to_string(pos));
@@ -701,12 +1134,12 @@ void MotionControllerDevice::moveAbsolute(const Tango::DevVarDoubleArray *argin)
     
     // 自动检查并使能电机（如果未使能）
     DEBUG_STREAM << "[SMC] Checking axis " << axis << " enable status..." << std::endl;
-    short sevon_status = smc_read_sevon_pin(card_id_, axis);
+    short sevon_status = SMC_QUERY(smc_read_sevon_pin, card_id_, axis);
     DEBUG_STREAM << "[SMC] smc_read_sevon_pin() returned: " << sevon_status << " (0=disabled, 1=enabled)" << std::endl;
     if (sevon_status == 0) {  // 0 = 未使能
         WARN_STREAM << "[SMC] Axis " << axis << " is not enabled, auto-enabling..." << std::endl;
         DEBUG_STREAM << "[SMC] smc_write_sevon_pin(card_id=" << card_id_ << ", axis=" << axis << ", on_off=1)" << std::endl;
-        short enable_ret = smc_write_sevon_pin(card_id_, axis, 1);
+        short enable_ret = SMC_CALL(smc_write_sevon_pin, card_id_, axis, 1);
         DEBUG_STREAM << "[SMC] smc_write_sevon_pin() returned: " << enable_ret << std::endl;
         if (enable_ret != 0) {
             WARN_STREAM << "[SMC] Failed to enable axis " << axis << ", error code: " << enable_ret 
@@ -717,7 +1150,7 @@ void MotionControllerDevice::moveAbsolute(const Tango::DevVarDoubleArray *argin)
     }
     
     DEBUG_STREAM << "[SMC] smc_pmove_unit(card_id=" << card_id_ << ", axis=" << axis << ", pos=" << pos << ", mode=absolute)" << std::endl;
-    short ret = smc_pmove_unit(card_id_, axis, pos, 1);  // 1 = absolute
+    short ret = SMC_CALL(smc_pmove_unit, card_id_, axis, pos, 1);  // 1 = absolute
     DEBUG_STREAM << "[SMC] smc_pmove_unit() returned: " << ret << std::endl;
     if (ret != 0) {
         std::lock_guard<std::mutex> lock(state_mutex_);
@@ -727,6 +1160,134 @@ void MotionControllerDevice::moveAbsolute(const Tango::DevVarDoubleArray *argin)
     result_value_ = 0;
 }
 
+void MotionControllerDevice::moveRelativeMulti(const Tango::DevVarDoubleArray *argin) {
+    move_multi(argin, true, "moveRelativeMulti");
+}
+
+void MotionControllerDevice::moveAbsoluteMulti(const Tango::DevVarDoubleArray *argin) {
+    move_multi(argin, false, "moveAbsoluteMulti");
+}
+
+void MotionControllerDevice::move_multi(const Tango::DevVarDoubleArray *argin, bool relative, const char *origin) {
+    check_connection();
+    if (argin->length() < 2 || argin->length() % 2 != 0) {
+        Tango::Except::throw_exception("InvalidArgs", "Requires [axis_id, value] pairs", origin);
+    }
+    std::vector<WORD> axes;
+    std::vector<double> values;
+    for (CORBA::ULong i = 0; i < argin->length(); i += 2) {
+        double axis_val = (*argin)[i];
+        if (axis_val < 0 || axis_val >= MAX_AXES || axis_val != std::floor(axis_val)) {
+            Tango::Except::throw_exception("InvalidArgs", "Axis id out of range: " + std::to_string(axis_val), origin);
+        }
+        WORD axis = static_cast<WORD>(axis_val);
+        if (std::find(axes.begin(), axes.end(), axis) != axes.end()) {
+            Tango::Except::throw_exception("InvalidArgs", "Duplicate axis " + std::to_string(axis), origin);
+        }
+        axes.push_back(axis);
+        values.push_back((*argin)[i + 1]);
+    }
+    
+    // 状态机检查
+    if (is_disabled_) {
+        Tango::Except::throw_exception("DISABLED", "Motion disabled by interlock", origin);
+    }
+    check_script_idle(origin);
+    if (get_state() == Tango::FAULT) {
+        Tango::Except::throw_exception("FAULT", "Device in fault state, reset required", origin);
+    }
+    if (pvt_stream_active_ && pvt_stream_crd_ == MULTI_MOVE_CRD) {
+        Tango::Except::throw_exception("StreamBusy", "Coordinate system is used by an active PVT stream", origin);
+    }
+    if (conti_open_ && conti_crd_ == MULTI_MOVE_CRD) {
+        Tango::Except::throw_exception("PathBusy", "Coordinate system is used by an open conti path", origin);
+    }
+    
+    if (sim_mode_) {
+        for (size_t k = 0; k < axes.size(); ++k) {
+            motor_pos_[axes[k]] = relative ? motor_pos_[axes[k]] + values[k] : values[k];
+        }
+        log_event(std::string("Simulation: ") + origin + " " + std::to_string(axes.size()) + " axes");
+        return;
+    }
+    
+    // 各轴行程（绝对运动需当前位置）与各轴速度曲线
+    std::vector<double> dist(axes.size());
+    double vector_len2 = 0.0;
+    for (size_t k = 0; k < axes.size(); ++k) {
+        double current = 0.0;
+        if (!relative) {
+            check_error(SMC_CALL(smc_get_position_unit, card_id_, axes[k], &current), std::string(origin) + "_smc_get_position_unit");
+        }
+        dist[k] = relative ? values[k] : values[k] - current;
+        vector_len2 += dist[k] * dist[k];
+    }
+    double vector_len = std::sqrt(vector_len2);
+    if (vector_len <= 0.0) {
+        result_value_ = 0;
+        return;  // 已在目标位置
+    }
+    // 合成速度取各轴 max_vel 约束下的最小值，使每轴分速度不超过其设定；加减速时间取各轴最大值
+    double vector_vel = 0.0, tacc = 0.0, tdec = 0.0;
+    for (size_t k = 0; k < axes.size(); ++k) {
+        double min_vel = 0, max_vel = 0, acc = 0, dec = 0, stop_vel = 0;
+        check_error(SMC_CALL(smc_get_profile_unit, card_id_, axes[k], &min_vel, &max_vel, &acc, &dec, &stop_vel),
+                    std::string(origin) + "_smc_get_profile_unit");
+        tacc = std::max(tacc, acc);
+        tdec = std::max(tdec, dec);
+        if (std::fabs(dist[k]) > 0.0) {
+            double limit = max_vel * vector_len / std::fabs(dist[k]);
+            vector_vel = (vector_vel <= 0.0) ? limit : std::min(vector_vel, limit);
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        note_motion_command();
+        for (WORD axis : axes) moving_axes_.insert(static_cast<short>(axis));
+        set_state(Tango::MOVING);
+        set_status(std::string("Moving - ") + origin + " " + std::to_string(axes.size()) + " axes");
+    }
+    
+    // 自动检查并使能电机（如果未使能）
+    for (WORD axis : axes) {
+        if (SMC_QUERY(smc_read_sevon_pin, card_id_, axis) == 0) {
+            WARN_STREAM << "[SMC] Axis " << axis << " is not enabled, auto-enabling..." << std::endl;
+            short enable_ret = SMC_CALL(smc_write_sevon_pin, card_id_, axis, 1);
+            if (enable_ret != 0) {
+                WARN_STREAM << "[SMC] Failed to enable axis " << axis << ", error code: " << enable_ret
+                           << ". Movement may fail." << std::endl;
+            }
+        }
+    }
+    
+    // 行程仅用于计算合成速度，下发时绝对运动仍用绝对目标，避免读位置与起动之间的偏差
+    WORD posi_mode = relative ? 0 : 1;
+    short ret = 0;
+    if (axes.size() == 1) {
+        DEBUG_STREAM << "[SMC] smc_pmove_unit(card_id=" << card_id_ << ", axis=" << axes[0] << ", value=" << values[0] << ", mode=" << posi_mode << ")" << std::endl;
+        ret = SMC_CALL(smc_pmove_unit, card_id_, axes[0], values[0], posi_mode);
+    } else {
+        DEBUG_STREAM << "[SMC] smc_set_vector_profile_unit(card_id=" << card_id_ << ", crd=" << MULTI_MOVE_CRD
+                  << ", max_vel=" << vector_vel << ", tacc=" << tacc << ", tdec=" << tdec << ")" << std::endl;
+        ret = SMC_CALL(smc_set_vector_profile_unit, card_id_, MULTI_MOVE_CRD, 0, vector_vel, tacc, tdec, 0);
+        if (ret == 0) {
+            DEBUG_STREAM << "[SMC] smc_line_unit(card_id=" << card_id_ << ", crd=" << MULTI_MOVE_CRD
+                      << ", axes=" << axes.size() << ", len=" << vector_len << ", mode=" << posi_mode << ")" << std::endl;
+            ret = SMC_CALL(smc_line_unit, card_id_, MULTI_MOVE_CRD, static_cast<WORD>(axes.size()), axes.data(), values.data(), posi_mode);
+        }
+        DEBUG_STREAM << "[SMC] smc_line_unit() returned: " << ret << std::endl;
+    }
+    if (ret != 0) {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        for (WORD axis : axes) moving_axes_.erase(static_cast<short>(axis));
+        if (moving_axes_.empty()) set_state(Tango::STANDBY);
+        check_error(ret, origin);
+    }
+    log_event(std::string(origin) + ": " + std::to_string(axes.size()) + " axes, vector length " + std::to_string(vector_len));
+    result_value_ = 0;
+}
+
 void MotionControllerDevice::stopMove(Tango::DevShort axis_id) {
     check_connection();
     
@@ -743,8 +1304,13 @@ void MotionControllerDevice::stopMove(Tango::DevShort axis_id) {
         return;
     }
     
+    if (pvt_stream_active_ &&
+        std::find(pvt_stream_axes_.begin(), pvt_stream_axes_.end(), axis_id) != pvt_stream_axes_.end()) {
+        stop_pvt_stream(true);
+    }
+    
     DEBUG_STREAM << "[SMC] smc_stop(card_id=" << card_id_ << ", axis=" << axis_id << ", mode=decelerate)" << std::endl;
-    short ret = smc_stop(card_id_, axis_id, 0);  // 0 = decelerate stop
+    short ret = SMC_CALL(smc_stop, card_id_, axis_id, 0);  // 0 = decelerate stop
     DEBUG_STREAM << "[SMC] smc_stop() returned: " << ret << std::endl;
     check_error(ret, "stopMove");
     
@@ -763,6 +1329,7 @@ void MotionControllerDevice::stopMove(Tango::DevShort axis_id) {
 // ========== PVTS Commands ==========
 void MotionControllerDevice::setPvts(Tango::DevString argin) {
     check_connection();
+    check_script_idle("setPvts");
     log_event(std::string("setPvts: ") + argin);
     
     if (sim_mode_) {
@@ -773,6 +1340,7 @@ void MotionControllerDevice::setPvts(Tango::DevString argin) {
     
     try {
         // 解析 JSON: {"axes": [0,1,2], "count": N, "time": [...], "pos": [[...],[...],...], "vel": [[...],[...],...]}
+        // 可选 "tolerance": PVT点精简允许偏差，缺省使用 pvtReduceTolerance 属性，<=0 不精简
         json j = json::parse(argin);
         
         if (j.count("axes") == 0 || j.count("count") == 0 || j.count("time") == 0 || 
@@ -796,66 +1364,19 @@ void MotionControllerDevice::setPvts(Tango::DevString argin) {
                 "pos/vel arrays size must match axes count", "setPvts");
         }
         
-        // 检查每个轴的状态
-        for (short axis : axes) {
-            // 检查运动状态
-            DEBUG_STREAM << "[PVT] Checking axis " << axis << " status..." << std::endl;
-            short done = smc_check_done(card_id_, axis);
-            if (done == 0) {  // 0 = 运动中
-                WARN_STREAM << "[PVT] Axis " << axis << " is moving, stopping it..." << std::endl;
-                smc_stop(card_id_, axis, 0);  // 减速停止
-                // 等待停止完成
-                int retry = 0;
-                while (smc_check_done(card_id_, axis) == 0 && retry < 50) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    retry++;
-                }
-            }
-            
-            // 检查 IO 状态
-            DEBUG_STREAM << "[PVT] Checking axis " << axis << " IO status..." << std::endl;
-            DWORD io_status = smc_axis_io_status(card_id_, axis);
-            // 检查报警、急停、限位
-            if (io_status & 0x10) {  // ALM
-                WARN_STREAM << "[PVT] Axis " << axis << " has ALM signal" << std::endl;
-            }
-            if (io_status & 0x20) {  // EMG
-                Tango::Except::throw_exception("EMG_Active", 
-                    "Axis " + std::to_string(axis) + " EMG active", "setPvts");
-            }
-            if ((io_status & 0x01) || (io_status & 0x02)) {  // EL+/EL-
-                Tango::Except::throw_exception("LIMIT_Active", 
-                    "Axis " + std::to_string(axis) + " limit active", "setPvts");
-            }
-        }
-        
-        // 下发 PVT 表到每个轴
+        double tolerance = j.value("tolerance", pvt_reduce_tolerance_);
+        std::vector<const double*> pos_ptrs, vel_ptrs;
         for (size_t i = 0; i < axes.size(); ++i) {
-            short axis = axes[i];
-            
-            // 检查并使能电机
-            short sevon_status = smc_read_sevon_pin(card_id_, axis);
-            if (sevon_status == 0) {
-                INFO_STREAM << "[PVT] Enabling axis " << axis << "..." << std::endl;
-                smc_write_sevon_pin(card_id_, axis, 1);
-            }
-            
-            DEBUG_STREAM << "[PVT] smc_pvt_table_unit(card_id=" << card_id_ 
-                      << ", axis=" << axis << ", count=" << count << ")" << std::endl;
-            
-            short ret = smc_pvt_table_unit(card_id_, axis, count, 
-                                          const_cast<double*>(time_array.data()),
-                                          const_cast<double*>(pos_arrays[i].data()),
-                                          const_cast<double*>(vel_arrays[i].data()));
-            
-            DEBUG_STREAM << "[PVT] smc_pvt_table_unit() returned: " << ret << std::endl;
-            
-            if (ret != 0) {
-                check_error(ret, "setPvts_smc_pvt_table_unit_axis_" + std::to_string(axis));
+            if (pos_arrays[i].size() != static_cast<size_t>(count) ||
+                vel_arrays[i].size() != static_cast<size_t>(count)) {
+                Tango::Except::throw_exception("InvalidData",
+                    "pos/vel array size != count for axis " + std::to_string(axes[i]), "setPvts");
             }
+            pos_ptrs.push_back(pos_arrays[i].data());
+            vel_ptrs.push_back(vel_arrays[i].data());
         }
         
-        INFO_STREAM << "[PVT] PVT table set successfully for " << axes.size() << " axes" << std::endl;
+        upload_pvt_tables(axes, count, time_array.data(), pos_ptrs, vel_ptrs, tolerance, "setPvts");
         result_value_ = 0;
         
     } catch (json::exception& e) {
@@ -863,6 +1384,153 @@ void MotionControllerDevice::setPvts(Tango::DevString argin) {
     }
 }
 
+// 二进制PVT下发: [axis_count, count, axes[axis_count], time[count], pos[axis_count][count], vel[axis_count][count], (tolerance)]
+// 数据直接从CORBA序列缓冲区传给 smc_pvt_table_unit，不经过JSON解析和中间拷贝。
+// 末尾可选的 tolerance 与 setPvts 的 "tolerance" 相同：PVT点精简允许偏差，省略时使用 pvtReduceTolerance 属性，<=0 不精简
+void MotionControllerDevice::setPvtsBinary(const Tango::DevVarDoubleArray *argin) {
+    check_connection();
+    check_script_idle("setPvtsBinary");
+    
+    const size_t length = argin->length();
+    if (length < 2) {
+        Tango::Except::throw_exception("InvalidArgs",
+            "Requires [axis_count, count, axes..., time..., pos..., vel..., (tolerance)]", "setPvtsBinary");
+    }
+    const double *buffer = argin->get_buffer();
+    size_t axis_count = 0, count = 0;
+    // count <= length 且 axis_count <= MAX_AXES，下面的长度计算不会溢出
+    if (!pvt_binary_index(buffer[0], MAX_AXES, axis_count) || !pvt_binary_index(buffer[1], length, count) ||
+        axis_count == 0 || count == 0) {
+        Tango::Except::throw_exception("InvalidData",
+            "axis_count/count header must be positive integers", "setPvtsBinary");
+    }
+    const size_t data_length = 2 + axis_count + count * (1 + 2 * axis_count);
+    if (length != data_length && length != data_length + 1) {
+        Tango::Except::throw_exception("InvalidData",
+            "Array length does not match axis_count/count header", "setPvtsBinary");
+    }
+    double tolerance = pvt_reduce_tolerance_;
+    if (length == data_length + 1) {
+        tolerance = buffer[data_length];
+        if (!std::isfinite(tolerance)) {
+            Tango::Except::throw_exception("InvalidData", "Tolerance must be finite", "setPvtsBinary");
+        }
+    }
+    log_event("setPvtsBinary: " + std::to_string(axis_count) + " axes, " + std::to_string(count) + " points");
+    
+    if (sim_mode_) {
+        log_event("Simulation: setPvtsBinary completed");
+        result_value_ = 0;
+        return;
+    }
+    
+    std::vector<short> axes(axis_count);
+    std::vector<const double*> pos_ptrs(axis_count), vel_ptrs(axis_count);
+    const double *time_ptr = buffer + 2 + axis_count;
+    for (size_t i = 0; i < axis_count; ++i) {
+        size_t axis = 0;
+        if (!pvt_binary_index(buffer[2 + i], MAX_AXES - 1, axis)) {
+            Tango::Except::throw_exception("InvalidData",
+                "Axis out of range: " + std::to_string(buffer[2 + i]), "setPvtsBinary");
+        }
+        axes[i] = static_cast<short>(axis);
+        pos_ptrs[i] = time_ptr + count * (1 + i);
+        vel_ptrs[i] = time_ptr + count * (1 + axis_count + i);
+    }
+    
+    upload_pvt_tables(axes, count, time_ptr, pos_ptrs, vel_ptrs, tolerance, "setPvtsBinary");
+    result_value_ = 0;
+}
+
+// 检查各轴状态并逐轴下发PVT表（各轴独立精简）
+void MotionControllerDevice::upload_pvt_tables(const std::vector<short> &axes, size_t count, const double *time,
+                                               const std::vector<const double*> &pos,
+                                               const std::vector<const double*> &vel,
+                                               double tolerance, const std::string &origin) {
+    // 检查每个轴的状态
+    for (short axis : axes) {
+        // 检查运动状态
+        DEBUG_STREAM << "[PVT] Checking axis " << axis << " status..." << std::endl;
+        short done = SMC_QUERY(smc_check_done, card_id_, axis);
+        if (done == 0) {  // 0 = 运动中
+            WARN_STREAM << "[PVT] Axis " << axis << " is moving, stopping it..." << std::endl;
+            SMC_CALL(smc_stop, card_id_, axis, 0);  // 减速停止
+            // 等待停止完成
+            int retry = 0;
+            while (SMC_QUERY(smc_check_done, card_id_, axis) == 0 && retry < 50) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                retry++;
+            }
+        }
+        
+        // 检查 IO 状态
+        DEBUG_STREAM << "[PVT] Checking axis " << axis << " IO status..." << std::endl;
+        DWORD io_status = SMC_CALL(smc_axis_io_status, card_id_, axis);
+        // 检查报警、急停、限位
+        if (io_status & 0x10) {  // ALM
+            WARN_STREAM << "[PVT] Axis " << axis << " has ALM signal" << std::endl;
+        }
+        if (io_status & 0x20) {  // EMG
+            Tango::Except::throw_exception("EMG_Active", 
+                "Axis " + std::to_string(axis) + " EMG active", origin);
+        }
+        if ((io_status & 0x01) || (io_status & 0x02)) {  // EL+/EL-
+            Tango::Except::throw_exception("LIMIT_Active", 
+                "Axis " + std::to_string(axis) + " limit active", origin);
+        }
+    }
+    
+    // 下发 PVT 表到每个轴
+    for (size_t i = 0; i < axes.size(); ++i) {
+        short axis = axes[i];
+        
+        // 各轴独立精简：控制器按轴插补，每个轴可使用各自的时间序列
+        std::vector<size_t> kept = Common::TrajectoryPlanner::reducePVTPoints(
+            time, pos[i], vel[i], count, tolerance);
+        // 未删点时直接使用调用方缓冲区，否则只拷贝保留的点
+        const double *axis_time = time, *axis_pos = pos[i], *axis_vel = vel[i];
+        std::vector<double> reduced_time, reduced_pos, reduced_vel;
+        if (kept.size() < count) {
+            reduced_time.resize(kept.size());
+            reduced_pos.resize(kept.size());
+            reduced_vel.resize(kept.size());
+            for (size_t k = 0; k < kept.size(); ++k) {
+                reduced_time[k] = time[kept[k]];
+                reduced_pos[k] = pos[i][kept[k]];
+                reduced_vel[k] = vel[i][kept[k]];
+            }
+            axis_time = reduced_time.data();
+            axis_pos = reduced_pos.data();
+            axis_vel = reduced_vel.data();
+            DEBUG_STREAM << "[PVT] Axis " << axis << " reduced " << count << " -> " << kept.size()
+                         << " points (tolerance " << tolerance << ")" << std::endl;
+        }
+        
+        // 检查并使能电机
+        short sevon_status = SMC_QUERY(smc_read_sevon_pin, card_id_, axis);
+        if (sevon_status == 0) {
+            INFO_STREAM << "[PVT] Enabling axis " << axis << "..." << std::endl;
+            SMC_CALL(smc_write_sevon_pin, card_id_, axis, 1);
+        }
+        
+        DEBUG_STREAM << "[PVT] smc_pvt_table_unit(card_id=" << card_id_ 
+                  << ", axis=" << axis << ", count=" << kept.size() << ")" << std::endl;
+        
+        short ret = SMC_CALL(smc_pvt_table_unit, card_id_, axis, static_cast<DWORD>(kept.size()),
+                                      const_cast<double*>(axis_time),
+                                      const_cast<double*>(axis_pos),
+                                      const_cast<double*>(axis_vel));
+        
+        DEBUG_STREAM << "[PVT] smc_pvt_table_unit() returned: " << ret << std::endl;
+        
+        if (ret != 0) {
+            check_error(ret, origin + "_smc_pvt_table_unit_axis_" + std::to_string(axis));
+        }
+    }
+    
+    INFO_STREAM << "[PVT] PVT table set successfully for " << axes.size() << " axes" << std::endl;
+}
+
 void MotionControllerDevice::movePvts(Tango::DevString argin) {
     check_connection();
     log_event(std::string("movePvts: ") + argin);
@@ -871,6 +1539,7 @@ void MotionControllerDevice::movePvts(Tango::DevString argin) {
     if (is_disabled_) {
         Tango::Except::throw_exception("DISABLED", "Motion disabled by interlock", "movePvts");
     }
+    check_script_idle("movePvts");
     if (get_state() == Tango::FAULT) {
         Tango::Except::throw_exception("FAULT", "Device in fault state, reset required", "movePvts");
     }
@@ -906,6 +1575,7 @@ void MotionControllerDevice::movePvts(Tango::DevString argin) {
         // 状态机：添加所有轴到运动集合
         {
             std::lock_guard<std::mutex> lock(state_mutex_);
+            note_motion_command();
             for (short axis : axes) {
                 moving_axes_.insert(axis);
             }
@@ -922,7 +1592,7 @@ void MotionControllerDevice::movePvts(Tango::DevString argin) {
         }
         DEBUG_STREAM << "])" << std::endl;
         
-        short ret = smc_pvt_move(card_id_, axis_num, axis_list.data());
+        short ret = SMC_CALL(smc_pvt_move, card_id_, axis_num, axis_list.data());
         DEBUG_STREAM << "[PVT] smc_pvt_move() returned: " << ret << std::endl;
         
         if (ret != 0) {
@@ -942,36 +1612,1374 @@ void MotionControllerDevice::movePvts(Tango::DevString argin) {
     }
 }
 
-// ========== Parameter Configuration Commands ==========
-void MotionControllerDevice::setMoveParameter(const Tango::DevVarDoubleArray *argin) {
+// ========== PVT Streaming Commands ==========
+// PVT表不能在运动中追加，长轨迹改为经连续插补(conti)缓冲区流式下发：
+// 每个PVT点转为一段相对直线插补（段速 = 段长/段时间），开启前瞻使段间平滑过渡；
+// 主机侧最多缓存 PVT_STREAM_MAX_CHUNKS 块，后台线程按 smc_conti_remain_space 补充控制器缓冲区。
+void MotionControllerDevice::pvtStreamOpen(Tango::DevString argin) {
     check_connection();
-    if (argin->length() < 6) {
-        Tango::Except::throw_exception("InvalidArgs", 
-            "Requires [axis_id, start_vel, max_vel, acc_time, dec_time, stop_vel]", "setMoveParameter");
+    log_event(std::string("pvtStreamOpen: ") + argin);
+    
+    if (is_disabled_) {
+        Tango::Except::throw_exception("DISABLED", "Motion disabled by interlock", "pvtStreamOpen");
+    }
+    check_script_idle("pvtStreamOpen");
+    if (get_state() == Tango::FAULT) {
+        Tango::Except::throw_exception("FAULT", "Device in fault state, reset required", "pvtStreamOpen");
+    }
+    if (pvt_stream_active_) {
+        Tango::Except::throw_exception("StreamBusy", "A PVT stream is already active", "pvtStreamOpen");
+    }
+    if (conti_open_ && !conti_closed_) {
+        Tango::Except::throw_exception("PathBusy", "A conti path is open, stop it first", "pvtStreamOpen");
     }
-    short axis = (short)(*argin)[0];
-    double start_vel = (*argin)[1];
-    double max_vel = (*argin)[2];
-    double acc_time = (*argin)[3];
-    double dec_time = (*argin)[4];
-    double stop_vel = (*argin)[5];
     
-    if (sim_mode_) {
-        // 模拟模式：只记录日志
-        log_event("Simulation: setMoveParameter axis " + std::to_string(axis) + 
-                  " start_vel=" + std::to_string(start_vel) + 
-                  " max_vel=" + std::to_string(max_vel));
-        result_value_ = 0;
-        return;
+    std::vector<short> axes;
+    long lookahead = 32;
+    try {
+        // 解析 JSON: {"axes": [0,1,2], "crd": 0, "lookahead": 32}
+        json j = json::parse(argin);
+        if (j.count("axes") == 0) {
+            Tango::Except::throw_exception("InvalidJSON", "Required field: axes", "pvtStreamOpen");
+        }
+        axes = j["axes"].get<std::vector<short>>();
+        pvt_stream_crd_ = j.value("crd", 0);
+        lookahead = j.value("lookahead", 32L);
+    } catch (json::exception& e) {
+        Tango::Except::throw_exception("JSONParseError", e.what(), "pvtStreamOpen");
+    }
+    if (axes.empty()) {
+        Tango::Except::throw_exception("InvalidData", "axes array is empty", "pvtStreamOpen");
+    }
+    for (short axis : axes) {
+        if (axis < 0 || axis >= MAX_AXES) {
+            Tango::Except::throw_exception("InvalidData",
+                "Axis out of range: " + std::to_string(axis), "pvtStreamOpen");
+        }
     }
     
-    DEBUG_STREAM << "[SMC] smc_set_profile_unit(card_id=" << card_id_ << ", axis=" << axis 
-              << ", start_vel=" << start_vel << ", max_vel=" << max_vel 
-              << ", acc_time=" << acc_time << ", dec_time=" << dec_time 
-              << ", stop_vel=" << stop_vel << ")" << std::endl;
-    short ret = smc_set_profile_unit(card_id_, axis, start_vel, max_vel, acc_time, dec_time, stop_vel);
-    DEBUG_STREAM << "[SMC] smc_set_profile_unit() returned: " << ret << std::endl;
-    check_error(ret, "setMoveParameter");
+    if (pvt_stream_thread_.joinable()) {
+        pvt_stream_thread_.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(pvt_stream_mutex_);
+        pvt_stream_axes_.assign(axes.begin(), axes.end());
+        pvt_stream_queue_.clear();
+        pvt_stream_closing_ = false;
+        pvt_stream_error_.clear();
+    }
+    pvt_stream_pushed_ = 0;
+    pvt_stream_stop_ = false;
+    
+    if (!sim_mode_) {
+        for (short axis : axes) {
+            if (SMC_QUERY(smc_read_sevon_pin, card_id_, axis) == 0) {
+                INFO_STREAM << "[PVTStream] Enabling axis " << axis << "..." << std::endl;
+                SMC_CALL(smc_write_sevon_pin, card_id_, axis, 1);
+            }
+        }
+        // 路径误差允许值取较小值，保证平滑过渡不明显偏离原轨迹
+        short ret = SMC_CALL(smc_conti_set_lookahead_mode, card_id_, pvt_stream_crd_, 1, lookahead, 0.001, 0);
+        check_error(ret, "pvtStreamOpen_smc_conti_set_lookahead_mode");
+        ret = SMC_CALL(smc_conti_open_list, card_id_, pvt_stream_crd_, static_cast<WORD>(pvt_stream_axes_.size()),
+                                  pvt_stream_axes_.data());
+        check_error(ret, "pvtStreamOpen_smc_conti_open_list");
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        note_motion_command();
+        for (short axis : axes) {
+            moving_axes_.insert(axis);
+        }
+        set_state(Tango::MOVING);
+        set_status("Moving - PVT stream on " + std::to_string(axes.size()) + " axes");
+    }
+    pvt_stream_active_ = true;
+    pvt_stream_thread_ = std::thread(&MotionControllerDevice::pvt_stream_loop, this);
+    result_value_ = 0;
+}
+
+Tango::DevLong MotionControllerDevice::pvtStreamAppend(Tango::DevString argin) {
+    check_connection();
+    if (!pvt_stream_active_) {
+        Tango::Except::throw_exception("StreamClosed", "No active PVT stream", "pvtStreamAppend");
+    }
+    
+    PvtStreamChunk chunk;
+    bool last = false;
+    try {
+        // 解析 JSON: {"time": [...], "pos": [[...],[...],...], "vel": [[...],[...],...], "last": false}
+        json j = json::parse(argin);
+        if (j.count("time") == 0 || j.count("pos") == 0) {
+            Tango::Except::throw_exception("InvalidJSON", "Required fields: time, pos", "pvtStreamAppend");
+        }
+        chunk.time = j["time"].get<std::vector<double>>();
+        chunk.pos = j["pos"].get<std::vector<std::vector<double>>>();
+        if (j.count("vel")) {
+            chunk.vel = j["vel"].get<std::vector<std::vector<double>>>();
+        }
+        last = j.value("last", false);
+    } catch (json::exception& e) {
+        Tango::Except::throw_exception("JSONParseError", e.what(), "pvtStreamAppend");
+    }
+    if (chunk.pos.size() != pvt_stream_axes_.size()) {
+        Tango::Except::throw_exception("InvalidData", "pos array size must match axes count", "pvtStreamAppend");
+    }
+    for (const auto& axis_pos : chunk.pos) {
+        if (axis_pos.size() != chunk.time.size()) {
+            Tango::Except::throw_exception("InvalidData", "pos array size != time size", "pvtStreamAppend");
+        }
+    }
+    if (!chunk.vel.empty()) {
+        if (chunk.vel.size() != pvt_stream_axes_.size()) {
+            Tango::Except::throw_exception("InvalidData", "vel array size must match axes count", "pvtStreamAppend");
+        }
+        for (const auto& axis_vel : chunk.vel) {
+            if (axis_vel.size() != chunk.time.size()) {
+                Tango::Except::throw_exception("InvalidData", "vel array size != time size", "pvtStreamAppend");
+            }
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(pvt_stream_mutex_);
+    if (!pvt_stream_error_.empty()) {
+        Tango::Except::throw_exception("StreamError", pvt_stream_error_, "pvtStreamAppend");
+    }
+    if (pvt_stream_closing_) {
+        Tango::Except::throw_exception("StreamClosed", "Last chunk already appended", "pvtStreamAppend");
+    }
+    if (pvt_stream_queue_.size() >= PVT_STREAM_MAX_CHUNKS) {
+        // 调用方稍后重试即可，上传节奏由控制器消耗速度决定
+        Tango::Except::throw_exception("StreamBusy", "PVT stream buffer full, retry later", "pvtStreamAppend");
+    }
+    if (!chunk.time.empty()) {
+        pvt_stream_queue_.push_back(std::move(chunk));
+    }
+    pvt_stream_closing_ = last;
+    pvt_stream_cv_.notify_all();
+    return static_cast<Tango::DevLong>(PVT_STREAM_MAX_CHUNKS - pvt_stream_queue_.size());
+}
+
+void MotionControllerDevice::pvtStreamStop() {
+    check_connection();
+    log_event("pvtStreamStop");
+    stop_pvt_stream(!sim_mode_);
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        for (unsigned short axis : pvt_stream_axes_) {
+            moving_axes_.erase(axis);
+        }
+        if (moving_axes_.empty() && get_state() == Tango::MOVING) {
+            set_state(Tango::STANDBY);
+            set_status("Ready - PVT stream stopped");
+        }
+    }
+    result_value_ = 0;
+}
+
+Tango::DevString MotionControllerDevice::pvtStreamStatus() {
+    json status;
+    {
+        std::lock_guard<std::mutex> lock(pvt_stream_mutex_);
+        status["active"] = pvt_stream_active_.load();
+        status["queuedChunks"] = pvt_stream_queue_.size();
+        status["closing"] = pvt_stream_closing_;
+        status["error"] = pvt_stream_error_;
+    }
+    status["pushedSegments"] = pvt_stream_pushed_.load();
+    if (!sim_mode_ && is_connected_ && pvt_stream_active_) {
+        status["remainSpace"] = SMC_CALL(smc_conti_remain_space, card_id_, pvt_stream_crd_);
+        status["currentMark"] = SMC_CALL(smc_conti_read_current_mark, card_id_, pvt_stream_crd_);
+    }
+    return Tango::string_dup(status.dump().c_str());
+}
+
+void MotionControllerDevice::stop_pvt_stream(bool stop_list) {
+    bool was_active = pvt_stream_active_;
+    pvt_stream_stop_ = true;
+    pvt_stream_cv_.notify_all();
+    if (pvt_stream_thread_.joinable()) {
+        pvt_stream_thread_.join();
+    }
+    if (was_active && stop_list) {
+        short ret = SMC_CALL(smc_conti_stop_list, card_id_, pvt_stream_crd_, 0);  // 0 = 减速停止
+        DEBUG_STREAM << "[PVTStream] smc_conti_stop_list() returned: " << ret << std::endl;
+    }
+}
+
+// ========== Conti path ==========
+void MotionControllerDevice::contiOpen(Tango::DevString argin) {
+    check_connection();
+    log_event(std::string("contiOpen: ") + argin);
+    
+    if (is_disabled_) {
+        Tango::Except::throw_exception("DISABLED", "Motion disabled by interlock", "contiOpen");
+    }
+    check_script_idle("contiOpen");
+    if (get_state() == Tango::FAULT) {
+        Tango::Except::throw_exception("FAULT", "Device in fault state, reset required", "contiOpen");
+    }
+    if (conti_open_ && !conti_closed_) {
+        Tango::Except::throw_exception("PathBusy", "A conti path is already open", "contiOpen");
+    }
+    
+    std::vector<short> axes;
+    unsigned short crd = 1;
+    long lookahead_segments = 50;
+    double path_error = 0.001, lookahead_acc = 0.0;
+    bool blend = true;
+    try {
+        // 解析 JSON: {"crd":1, "axes":[0,1], "lookahead":50 | {"segments":50,"pathError":0.001,"acc":0}, "blend":true}
+        json j = json::parse(argin);
+        if (j.count("axes") == 0) {
+            Tango::Except::throw_exception("InvalidJSON", "Required field: axes", "contiOpen");
+        }
+        axes = j["axes"].get<std::vector<short>>();
+        crd = j.value("crd", static_cast<unsigned short>(1));
+        if (j.count("lookahead")) {
+            if (j["lookahead"].is_object()) {
+                lookahead_segments = j["lookahead"].value("segments", lookahead_segments);
+                path_error = j["lookahead"].value("pathError", path_error);
+                lookahead_acc = j["lookahead"].value("acc", lookahead_acc);
+            } else {
+                lookahead_segments = j["lookahead"].get<long>();
+            }
+        }
+        blend = j.value("blend", true);
+    } catch (json::exception& e) {
+        Tango::Except::throw_exception("JSONParseError", e.what(), "contiOpen");
+    }
+    if (axes.empty()) {
+        Tango::Except::throw_exception("InvalidData", "axes array is empty", "contiOpen");
+    }
+    for (short axis : axes) {
+        if (axis < 0 || axis >= MAX_AXES) {
+            Tango::Except::throw_exception("InvalidData",
+                "Axis out of range: " + std::to_string(axis), "contiOpen");
+        }
+    }
+    if (pvt_stream_active_ && pvt_stream_crd_ == crd) {
+        Tango::Except::throw_exception("StreamBusy", "Coordinate system is used by an active PVT stream", "contiOpen");
+    }
+    if (crd == MULTI_MOVE_CRD) {
+        Tango::Except::throw_exception("InvalidData",
+            "Coordinate system " + std::to_string(MULTI_MOVE_CRD) + " is reserved for synchronised multi-axis moves",
+            "contiOpen");
+    }
+    
+    if (!sim_mode_) {
+        for (short axis : axes) {
+            if (SMC_QUERY(smc_read_sevon_pin, card_id_, axis) == 0) {
+                INFO_STREAM << "[Conti] Enabling axis " << axis << "..." << std::endl;
+                SMC_CALL(smc_write_sevon_pin, card_id_, axis, 1);
+            }
+        }
+        short ret = SMC_CALL(smc_conti_set_lookahead_mode, card_id_, crd, lookahead_segments > 0 ? 1 : 0,
+                             lookahead_segments, path_error, lookahead_acc);
+        check_error(ret, "contiOpen_smc_conti_set_lookahead_mode");
+        ret = SMC_CALL(smc_conti_set_blend, card_id_, crd, blend ? 1 : 0);
+        check_error(ret, "contiOpen_smc_conti_set_blend");
+        std::vector<WORD> axis_list(axes.begin(), axes.end());
+        ret = SMC_CALL(smc_conti_open_list, card_id_, crd, static_cast<WORD>(axis_list.size()), axis_list.data());
+        check_error(ret, "contiOpen_smc_conti_open_list");
+    }
+    
+    conti_crd_ = crd;
+    conti_axes_.assign(axes.begin(), axes.end());
+    conti_segments_ = 0;
+    conti_closed_ = false;
+    conti_started_ = false;
+    conti_poll_crd_ = -1;
+    conti_open_ = true;
+    result_value_ = 0;
+}
+
+Tango::DevLong MotionControllerDevice::contiAppend(Tango::DevString argin) {
+    check_connection();
+    if (!conti_open_ || conti_closed_) {
+        Tango::Except::throw_exception("PathNotOpen", "No open conti path, call contiOpen first", "contiAppend");
+    }
+    
+    json j;
+    try {
+        // {"segments":[{"type":"line","pos":[..],"mode":"abs","vel":10,"tacc":0.1,"tdec":0.1,"mark":1},
+        //              {"type":"arc","pos":[..],"center":[..]|"radius":r|"mid":[..],"dir":0,"circle":0}],
+        //  "close": false}
+        j = json::parse(argin);
+    } catch (json::exception& e) {
+        Tango::Except::throw_exception("JSONParseError", e.what(), "contiAppend");
+    }
+    if (j.count("segments") == 0 || !j["segments"].is_array()) {
+        Tango::Except::throw_exception("InvalidJSON", "Required field: segments (array)", "contiAppend");
+    }
+    
+    const size_t n = conti_axes_.size();
+    for (const json &seg : j["segments"]) {
+        std::string type = seg.value("type", std::string("line"));
+        std::vector<double> pos = seg.value("pos", std::vector<double>());
+        if (pos.size() != n) {
+            Tango::Except::throw_exception("InvalidData",
+                "Segment pos must have " + std::to_string(n) + " values", "contiAppend");
+        }
+        WORD posi_mode = (seg.value("mode", std::string("abs")) == "rel") ? 0 : 1;
+        long mark = seg.value("mark", conti_segments_ + 1);
+        
+        if (sim_mode_) {
+            for (size_t k = 0; k < n; ++k) {
+                motor_pos_[conti_axes_[k]] = posi_mode ? pos[k] : motor_pos_[conti_axes_[k]] + pos[k];
+            }
+            ++conti_segments_;
+            continue;
+        }
+        
+        short ret = 0;
+        if (seg.count("vel")) {
+            // 段速度在列表中生效，作用于其后的段
+            ret = SMC_CALL(smc_set_vector_profile_unit, card_id_, conti_crd_, 0, seg["vel"].get<double>(),
+                           seg.value("tacc", 0.1), seg.value("tdec", 0.1), 0);
+            check_error(ret, "contiAppend_smc_set_vector_profile_unit");
+        }
+        if (type == "line") {
+            ret = SMC_CALL(smc_conti_line_unit, card_id_, conti_crd_, static_cast<WORD>(n), conti_axes_.data(),
+                           pos.data(), posi_mode, mark);
+        } else if (type == "arc") {
+            if (n < 2) {
+                Tango::Except::throw_exception("InvalidData", "Arc segments need at least 2 axes", "contiAppend");
+            }
+            long circle = seg.value("circle", 0L);
+            if (seg.count("center")) {
+                std::vector<double> center = seg["center"].get<std::vector<double>>();
+                if (center.size() != n) {
+                    Tango::Except::throw_exception("InvalidData", "Arc center size mismatch", "contiAppend");
+                }
+                ret = SMC_CALL(smc_conti_arc_move_center_unit, card_id_, conti_crd_, static_cast<WORD>(n),
+                               conti_axes_.data(), pos.data(), center.data(), seg.value("dir", 0), circle, posi_mode, mark);
+            } else if (seg.count("radius")) {
+                ret = SMC_CALL(smc_conti_arc_move_radius_unit, card_id_, conti_crd_, static_cast<WORD>(n),
+                               conti_axes_.data(), pos.data(), seg["radius"].get<double>(), seg.value("dir", 0),
+                               circle, posi_mode, mark);
+            } else if (seg.count("mid")) {
+                std::vector<double> mid = seg["mid"].get<std::vector<double>>();
+                if (mid.size() != n) {
+                    Tango::Except::throw_exception("InvalidData", "Arc mid point size mismatch", "contiAppend");
+                }
+                ret = SMC_CALL(smc_conti_arc_move_3points_unit, card_id_, conti_crd_, static_cast<WORD>(n),
+                               conti_axes_.data(), pos.data(), mid.data(), circle, posi_mode, mark);
+            } else {
+                Tango::Except::throw_exception("InvalidData", "Arc needs center, radius or mid", "contiAppend");
+            }
+        } else {
+            Tango::Except::throw_exception("InvalidData", "Unknown segment type: " + type, "contiAppend");
+        }
+        check_error(ret, "contiAppend_" + type);
+        ++conti_segments_;
+    }
+    
+    if (j.value("close", false)) {
+        if (!sim_mode_) {
+            check_error(SMC_CALL(smc_conti_close_list, card_id_, conti_crd_), "contiAppend_smc_conti_close_list");
+        }
+        conti_closed_ = true;
+    }
+    result_value_ = 0;
+    if (sim_mode_) return 1000;
+    return SMC_CALL(smc_conti_remain_space, card_id_, conti_crd_);
+}
+
+void MotionControllerDevice::contiStart() {
+    check_connection();
+    if (!conti_open_) {
+        Tango::Except::throw_exception("PathNotOpen", "No open conti path, call contiOpen first", "contiStart");
+    }
+    if (is_disabled_) {
+        Tango::Except::throw_exception("DISABLED", "Motion disabled by interlock", "contiStart");
+    }
+    check_script_idle("contiStart");
+    if (get_state() == Tango::FAULT) {
+        Tango::Except::throw_exception("FAULT", "Device in fault state, reset required", "contiStart");
+    }
+    log_event("contiStart: crd " + std::to_string(conti_crd_) + ", " + std::to_string(conti_segments_) + " segments");
+    if (sim_mode_) {
+        conti_started_ = true;
+        result_value_ = 0;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        note_motion_command();
+        for (unsigned short axis : conti_axes_) {
+            moving_axes_.insert(static_cast<short>(axis));
+        }
+        set_state(Tango::MOVING);
+        set_status("Moving - Conti path on crd " + std::to_string(conti_crd_));
+    }
+    short ret = SMC_CALL(smc_conti_start_list, card_id_, conti_crd_);
+    if (ret != 0) {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        for (unsigned short axis : conti_axes_) {
+            moving_axes_.erase(static_cast<short>(axis));
+        }
+        if (moving_axes_.empty()) set_state(Tango::STANDBY);
+        check_error(ret, "contiStart");
+    }
+    conti_poll_crd_ = conti_crd_;
+    conti_started_ = true;
+    result_value_ = 0;
+}
+
+void MotionControllerDevice::contiPause() {
+    check_connection();
+    if (!conti_open_) {
+        Tango::Except::throw_exception("PathNotOpen", "No open conti path", "contiPause");
+    }
+    log_event("contiPause");
+    if (!sim_mode_) {
+        check_error(SMC_CALL(smc_conti_pause_list, card_id_, conti_crd_), "contiPause");
+    }
+    set_status("Paused - Conti path on crd " + std::to_string(conti_crd_));
+    result_value_ = 0;
+}
+
+void MotionControllerDevice::contiStop(Tango::DevShort stop_mode) {
+    check_connection();
+    if (!conti_open_) {
+        return;
+    }
+    log_event("contiStop: mode " + std::to_string(stop_mode));
+    if (!sim_mode_) {
+        short ret = SMC_CALL(smc_conti_stop_list, card_id_, conti_crd_, stop_mode ? 1 : 0);
+        DEBUG_STREAM << "[Conti] smc_conti_stop_list() returned: " << ret << std::endl;
+        if (!conti_closed_) {
+            SMC_CALL(smc_conti_close_list, card_id_, conti_crd_);
+        }
+    }
+    conti_open_ = false;
+    conti_closed_ = true;
+    conti_poll_crd_ = -1;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        for (unsigned short axis : conti_axes_) {
+            moving_axes_.erase(static_cast<short>(axis));
+        }
+        if (moving_axes_.empty() && get_state() == Tango::MOVING) {
+            set_state(Tango::STANDBY);
+            set_status("Ready - Conti path stopped");
+        }
+    }
+    result_value_ = 0;
+}
+
+void MotionControllerDevice::contiSetOverride(Tango::DevDouble percent) {
+    check_connection();
+    if (percent < 0 || percent > 200) {
+        Tango::Except::throw_exception("InvalidArgs", "Override must be 0-200 %", "contiSetOverride");
+    }
+    if (!sim_mode_) {
+        check_error(SMC_CALL(smc_conti_set_override, card_id_, conti_crd_, percent), "contiSetOverride");
+    }
+    log_event("contiSetOverride: " + std::to_string(percent) + "%");
+    result_value_ = 0;
+}
+
+Tango::DevString MotionControllerDevice::contiStatus() {
+    json status;
+    status["open"] = conti_open_;
+    status["closed"] = conti_closed_;
+    status["crd"] = conti_crd_;
+    status["axes"] = conti_axes_;
+    status["segments"] = conti_segments_;
+    if (!sim_mode_ && is_connected_ && conti_open_) {
+        status["runState"] = SMC_QUERY(smc_conti_get_run_state, card_id_, conti_crd_);
+        status["remainSpace"] = SMC_CALL(smc_conti_remain_space, card_id_, conti_crd_);
+        status["currentMark"] = SMC_CALL(smc_conti_read_current_mark, card_id_, conti_crd_);
+    }
+    return Tango::string_dup(status.dump().c_str());
+}
+
+// 后台压段线程：按控制器剩余空间把主机侧分块转换为插补段。
+// 每段为相邻两点间的直线，起/终点合成速度取规划速度（未给出时取相邻段平均速度），
+// 加减速时间为段时长的 PVT_STREAM_RAMP_RATIO，最大速度按梯形面积反算使段时长等于 dt。
+// 与 PVT 的偏差：点间走弦线而非三次曲线；控制器前瞻重算拐点速度时段时长会有小幅偏差；
+// 规划速度与弦长不相容（梯形无解）的段退化为恒速 dist/dt，段首尾存在速度跳变。
+void MotionControllerDevice::pvt_stream_loop() {
+    const size_t axis_count = pvt_stream_axes_.size();
+    std::vector<double> last_pos(axis_count, 0.0);
+    std::vector<double> delta(axis_count, 0.0);
+    double last_time = 0.0;
+    double last_speed = 0.0;                 // 上一点的合成速度，流起点为0
+    bool started = false;
+    PvtStreamChunk current;
+    size_t cursor = 0;
+    
+    while (!pvt_stream_stop_) {
+        if (cursor >= current.time.size()) {
+            std::unique_lock<std::mutex> lock(pvt_stream_mutex_);
+            pvt_stream_cv_.wait_for(lock, std::chrono::milliseconds(20), [this] {
+                return pvt_stream_stop_ || !pvt_stream_queue_.empty() || pvt_stream_closing_;
+            });
+            if (pvt_stream_stop_) break;
+            if (pvt_stream_queue_.empty()) {
+                if (pvt_stream_closing_) break;   // 全部段已压入
+                continue;
+            }
+            current = std::move(pvt_stream_queue_.front());
+            pvt_stream_queue_.pop_front();
+            cursor = 0;
+        }
+        
+        if (sim_mode_) {
+            pvt_stream_pushed_ += static_cast<long>(current.time.size());
+            last_time = current.time.back();
+            cursor = current.time.size();
+            continue;
+        }
+        
+        long space = SMC_CALL(smc_conti_remain_space, card_id_, pvt_stream_crd_);
+        if (space <= 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        
+        short ret = 0;
+        for (; space > 0 && cursor < current.time.size() && ret == 0; --space, ++cursor) {
+            double dt = current.time[cursor] - last_time;
+            double dist2 = 0.0;
+            for (size_t a = 0; a < axis_count; ++a) {
+                delta[a] = current.pos[a][cursor] - last_pos[a];
+                dist2 += delta[a] * delta[a];
+            }
+            long mark = pvt_stream_pushed_ + 1;
+            if (dt <= 0.0) {
+                continue;   // 与上一点同时刻（如分块首点重复），跳过
+            }
+            double end_speed = 0.0;
+            if (dist2 < 1e-18) {
+                ret = SMC_CALL(smc_conti_delay, card_id_, pvt_stream_crd_, dt, mark);
+            } else {
+                double dist = std::sqrt(dist2);
+                double v_start = last_speed;
+                double v_end = dist / dt;
+                if (!current.vel.empty()) {
+                    double vel2 = 0.0;
+                    for (size_t a = 0; a < axis_count; ++a) {
+                        vel2 += current.vel[a][cursor] * current.vel[a][cursor];
+                    }
+                    v_end = std::sqrt(vel2);
+                }
+                // 梯形：v_start 经 ramp 升到 v_max，匀速，再经 ramp 降到 v_end，总时长 dt
+                double ramp = PVT_STREAM_RAMP_RATIO * dt;
+                double v_max = (dist - 0.5 * ramp * (v_start + v_end)) / (dt - ramp);
+                if (v_max < std::max(v_start, v_end)) {
+                    v_start = v_end = v_max = dist / dt;
+                }
+                end_speed = v_end;
+                ret = SMC_CALL(smc_set_vector_profile_unit, card_id_, pvt_stream_crd_, v_start, v_max, ramp, ramp, v_end);
+                if (ret == 0) {
+                    ret = SMC_CALL(smc_conti_line_unit, card_id_, pvt_stream_crd_, static_cast<WORD>(axis_count),
+                                              pvt_stream_axes_.data(), delta.data(), 0, mark);  // 0 = 相对
+                }
+            }
+            if (ret == 0) {
+                ++pvt_stream_pushed_;
+                last_speed = end_speed;
+                last_time = current.time[cursor];
+                for (size_t a = 0; a < axis_count; ++a) {
+                    last_pos[a] = current.pos[a][cursor];
+                }
+            }
+        }
+        if (ret != 0) {
+            std::lock_guard<std::mutex> lock(pvt_stream_mutex_);
+            pvt_stream_error_ = "conti segment upload failed with error code " + std::to_string(ret);
+            ERROR_STREAM << "[PVTStream] " << pvt_stream_error_ << std::endl;
+            SMC_CALL(smc_conti_stop_list, card_id_, pvt_stream_crd_, 0);
+            break;
+        }
+        if (!started && pvt_stream_pushed_ > 0) {
+            ret = SMC_CALL(smc_conti_start_list, card_id_, pvt_stream_crd_);
+            DEBUG_STREAM << "[PVTStream] smc_conti_start_list() returned: " << ret << std::endl;
+            started = true;
+        }
+    }
+    
+    if (!sim_mode_ && !pvt_stream_stop_) {
+        if (!started && pvt_stream_pushed_ > 0) {
+            SMC_CALL(smc_conti_start_list, card_id_, pvt_stream_crd_);
+        }
+        SMC_CALL(smc_conti_close_list, card_id_, pvt_stream_crd_);
+    }
+    INFO_STREAM << "[PVTStream] Stream finished, " << pvt_stream_pushed_.load() << " segments pushed, "
+                << last_time << " s" << std::endl;
+    pvt_stream_active_ = false;
+}
+
+// ========== Parameter Configuration Commands ==========
+// ========== Position compare (hcmp) ==========
+void MotionControllerDevice::hcmpConfig(Tango::DevString argin) {
+    check_connection();
+    log_event(std::string("hcmpConfig: ") + argin);
+    WORD hcmp = 0, axis = 0, source = 1, logic = 0, mode = 4;
+    long pulse_us = 1000;
+    try {
+        // mode: "disable"=0, "queue"=4（逐点比较）, "linear"=5（等间距比较）
+        // source: 0=指令位置, 1=编码器位置；logic: 0=低电平有效, 1=高电平有效；pulseUs: 输出脉冲宽度(us)
+        json j = json::parse(argin);
+        hcmp = j.value("hcmp", static_cast<WORD>(0));
+        axis = j.at("axis").get<WORD>();
+        std::string mode_name = j.value("mode", std::string("queue"));
+        if (mode_name == "disable") mode = 0;
+        else if (mode_name == "queue") mode = 4;
+        else if (mode_name == "linear") mode = 5;
+        else Tango::Except::throw_exception("InvalidData", "Unknown hcmp mode: " + mode_name, "hcmpConfig");
+        source = j.value("source", static_cast<WORD>(1));
+        logic = j.value("logic", static_cast<WORD>(0));
+        pulse_us = j.value("pulseUs", 1000L);
+    } catch (json::exception& e) {
+        Tango::Except::throw_exception("JSONParseError", e.what(), "hcmpConfig");
+    }
+    if (axis >= MAX_AXES) {
+        Tango::Except::throw_exception("InvalidData", "Axis out of range: " + std::to_string(axis), "hcmpConfig");
+    }
+    if (pulse_us <= 0) {
+        Tango::Except::throw_exception("InvalidData", "pulseUs must be positive", "hcmpConfig");
+    }
+    if (sim_mode_) {
+        result_value_ = 0;
+        return;
+    }
+    check_error(SMC_CALL(smc_hcmp_set_mode, card_id_, hcmp, mode), "hcmpConfig_smc_hcmp_set_mode");
+    check_error(SMC_CALL(smc_hcmp_set_config, card_id_, hcmp, axis, source, logic, pulse_us),
+                "hcmpConfig_smc_hcmp_set_config");
+    result_value_ = 0;
+}
+
+void MotionControllerDevice::hcmpAddPoints(const Tango::DevVarDoubleArray *argin) {
+    check_connection();
+    if (argin->length() < 2) {
+        Tango::Except::throw_exception("InvalidArgs", "Requires [hcmp, pos1, pos2, ...]", "hcmpAddPoints");
+    }
+    WORD hcmp = static_cast<WORD>((*argin)[0]);
+    if (sim_mode_) {
+        log_event("Simulation: hcmpAddPoints " + std::to_string(argin->length() - 1) + " points");
+        result_value_ = 0;
+        return;
+    }
+    for (CORBA::ULong i = 1; i < argin->length(); ++i) {
+        short ret = SMC_CALL(smc_hcmp_add_point_unit, card_id_, hcmp, (*argin)[i]);
+        check_error(ret, "hcmpAddPoints point " + std::to_string(i - 1));
+    }
+    log_event("hcmpAddPoints: hcmp " + std::to_string(hcmp) + ", " + std::to_string(argin->length() - 1) + " points");
+    result_value_ = 0;
+}
+
+void MotionControllerDevice::hcmpSetLinear(const Tango::DevVarDoubleArray *argin) {
+    check_connection();
+    if (argin->length() < 4) {
+        Tango::Except::throw_exception("InvalidArgs", "Requires [hcmp, start_pos, increment, count]", "hcmpSetLinear");
+    }
+    WORD hcmp = static_cast<WORD>((*argin)[0]);
+    double start = (*argin)[1];
+    double increment = (*argin)[2];
+    long count = static_cast<long>((*argin)[3]);
+    if (count <= 0 || increment == 0.0) {
+        Tango::Except::throw_exception("InvalidArgs", "count must be positive and increment non-zero", "hcmpSetLinear");
+    }
+    log_event("hcmpSetLinear: hcmp " + std::to_string(hcmp) + ", start " + std::to_string(start) +
+              ", step " + std::to_string(increment) + " x " + std::to_string(count));
+    if (sim_mode_) {
+        result_value_ = 0;
+        return;
+    }
+    // 线性模式：首点为起始比较位置，之后每隔 increment 触发一次，共 count 次
+    check_error(SMC_CALL(smc_hcmp_clear_points, card_id_, hcmp), "hcmpSetLinear_smc_hcmp_clear_points");
+    check_error(SMC_CALL(smc_hcmp_set_liner_unit, card_id_, hcmp, increment, count), "hcmpSetLinear_smc_hcmp_set_liner_unit");
+    check_error(SMC_CALL(smc_hcmp_add_point_unit, card_id_, hcmp, start), "hcmpSetLinear_smc_hcmp_add_point_unit");
+    result_value_ = 0;
+}
+
+void MotionControllerDevice::hcmpClear(Tango::DevShort hcmp) {
+    check_connection();
+    if (!sim_mode_) {
+        check_error(SMC_CALL(smc_hcmp_clear_points, card_id_, hcmp), "hcmpClear");
+    }
+    log_event("hcmpClear: hcmp " + std::to_string(hcmp));
+    result_value_ = 0;
+}
+
+Tango::DevVarDoubleArray *MotionControllerDevice::hcmpStatus(Tango::DevShort hcmp) {
+    check_connection();
+    long remained = 0, runned = 0;
+    double current = 0.0;
+    if (!sim_mode_) {
+        check_error(SMC_CALL(smc_hcmp_get_current_state_unit, card_id_, hcmp, &remained, &current, &runned), "hcmpStatus");
+    }
+    Tango::DevVarDoubleArray *result = new Tango::DevVarDoubleArray();
+    result->length(3);
+    (*result)[0] = static_cast<double>(remained);
+    (*result)[1] = current;
+    (*result)[2] = static_cast<double>(runned);
+    return result;
+}
+
+// ========== Position latch ==========
+void MotionControllerDevice::latchArm(Tango::DevString argin) {
+    check_connection();
+    log_event(std::string("latchArm: ") + argin);
+    int latch = 0;
+    LatchConfig cfg;
+    WORD mode = 1, logic = 0, source = 1;
+    double filter = 0.0;
+    try {
+        // type: "ltc"（默认，锁存通道可连续锁存多次）或 "axis"（smc_set_latch_mode，每轴锁存一次）
+        // mode: "single"=0 / "multi"=1；logic: 0=下降沿, 1=上升沿；source: 0=指令位置, 1=编码器位置
+        json j = json::parse(argin);
+        latch = j.value("latch", 0);
+        cfg.axes = j.at("axes").get<std::vector<unsigned short>>();
+        cfg.axis_latch = (j.value("type", std::string("ltc")) == "axis");
+        mode = (j.value("mode", std::string("multi")) == "single") ? 0 : 1;
+        logic = j.value("logic", static_cast<WORD>(0));
+        source = j.value("source", static_cast<WORD>(1));
+        filter = j.value("filter", 0.0);
+    } catch (json::exception& e) {
+        Tango::Except::throw_exception("JSONParseError", e.what(), "latchArm");
+    }
+    if (latch < 0 || cfg.axes.empty()) {
+        Tango::Except::throw_exception("InvalidData", "latch must be >= 0 and axes non-empty", "latchArm");
+    }
+    for (unsigned short axis : cfg.axes) {
+        if (axis >= MAX_AXES) {
+            Tango::Except::throw_exception("InvalidData", "Axis out of range: " + std::to_string(axis), "latchArm");
+        }
+    }
+    
+    if (!sim_mode_) {
+        if (cfg.axis_latch) {
+            for (unsigned short axis : cfg.axes) {
+                check_error(SMC_CALL(smc_set_ltc_mode, card_id_, axis, logic, mode, filter), "latchArm_smc_set_ltc_mode");
+                check_error(SMC_CALL(smc_set_latch_mode, card_id_, axis, 1, source, static_cast<WORD>(latch)),
+                            "latchArm_smc_set_latch_mode");
+                check_error(SMC_CALL(smc_reset_latch_flag, card_id_, axis), "latchArm_smc_reset_latch_flag");
+            }
+        } else {
+            check_error(SMC_CALL(smc_ltc_set_mode, card_id_, static_cast<WORD>(latch), mode, logic, filter),
+                        "latchArm_smc_ltc_set_mode");
+            for (unsigned short axis : cfg.axes) {
+                check_error(SMC_CALL(smc_ltc_set_source, card_id_, static_cast<WORD>(latch), axis, source),
+                            "latchArm_smc_ltc_set_source");
+            }
+            // 复位即清空锁存缓冲并开始等待触发
+            check_error(SMC_CALL(smc_ltc_reset, card_id_, static_cast<WORD>(latch)), "latchArm_smc_ltc_reset");
+        }
+    }
+    latch_configs_[latch] = cfg;
+    result_value_ = 0;
+}
+
+Tango::DevVarDoubleArray *MotionControllerDevice::latchRead(Tango::DevShort latch) {
+    check_connection();
+    auto it = latch_configs_.find(latch);
+    if (it == latch_configs_.end()) {
+        Tango::Except::throw_exception("LatchNotArmed", "Latch " + std::to_string(latch) + " is not armed", "latchRead");
+    }
+    const LatchConfig &cfg = it->second;
+    
+    // 每轴读出全部锁存值（读取即出队）
+    std::vector<std::vector<double>> values(cfg.axes.size());
+    if (!sim_mode_) {
+        for (size_t k = 0; k < cfg.axes.size(); ++k) {
+            WORD axis = cfg.axes[k];
+            double value = 0.0;
+            if (cfg.axis_latch) {
+                if (SMC_QUERY(smc_get_latch_flag, card_id_, axis) > 0) {
+                    check_error(SMC_CALL(smc_get_latch_value_unit, card_id_, axis, &value), "latchRead_smc_get_latch_value_unit");
+                    values[k].push_back(value);
+                    SMC_CALL(smc_reset_latch_flag, card_id_, axis);
+                }
+                continue;
+            }
+            int number = 0;
+            check_error(SMC_CALL(smc_ltc_get_number, card_id_, static_cast<WORD>(latch), axis, &number),
+                        "latchRead_smc_ltc_get_number");
+            for (int i = 0; i < number; ++i) {
+                check_error(SMC_CALL(smc_ltc_get_value_unit, card_id_, static_cast<WORD>(latch), axis, &value),
+                            "latchRead_smc_ltc_get_value_unit");
+                values[k].push_back(value);
+            }
+        }
+    }
+    
+    size_t total = 1;
+    json published = json::object();
+    for (size_t k = 0; k < cfg.axes.size(); ++k) {
+        total += 2 + values[k].size();
+        published[std::to_string(cfg.axes[k])] = values[k];
+    }
+    Tango::DevVarDoubleArray *result = new Tango::DevVarDoubleArray();
+    result->length(static_cast<CORBA::ULong>(total));
+    size_t idx = 0;
+    (*result)[idx++] = static_cast<double>(cfg.axes.size());
+    for (size_t k = 0; k < cfg.axes.size(); ++k) {
+        (*result)[idx++] = cfg.axes[k];
+        (*result)[idx++] = static_cast<double>(values[k].size());
+        for (double v : values[k]) (*result)[idx++] = v;
+    }
+    
+    json attr_json;
+    attr_json["latch"] = latch;
+    attr_json["stampMs"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    attr_json["positions"] = published;
+    latched_positions_json_ = attr_json.dump();
+    Tango::DevString val = const_cast<char*>(latched_positions_json_.c_str());
+    push_change_event("latchedPositions", &val);
+    return result;
+}
+
+void MotionControllerDevice::read_latchedPositions(Tango::Attribute &attr) {
+    attr_latchedPositions_read = Tango::string_dup(latched_positions_json_.c_str());
+    attr.set_value(&attr_latchedPositions_read);
+}
+
+// ========== Controller scripts ==========
+// 脚本运行或暂停期间轴由控制器程序驱动，拒绝主机侧运动指令
+void MotionControllerDevice::check_script_idle(const std::string &origin) {
+    if (script_running_) {
+        Tango::Except::throw_exception("ScriptActive",
+            "Controller script " + script_name_ + " is " + (script_paused_ ? "paused" : "running") + ", call scriptStop first",
+            origin);
+    }
+}
+
+void MotionControllerDevice::scriptLoad(Tango::DevString argin) {
+    check_connection();
+    std::string type, name, text;
+    try {
+        json j = json::parse(argin);
+        std::map<std::string, std::string> values;
+        if (j.count("template")) {
+            std::string tpl_name = j["template"].get<std::string>();
+            auto it = script_templates_.find(tpl_name);
+            if (it == script_templates_.end()) {
+                Tango::Except::throw_exception("InvalidData", "Unknown script template: " + tpl_name, "scriptLoad");
+            }
+            type = it->second.type;
+            text = it->second.text;
+            values = it->second.defaults;
+            name = tpl_name;
+        } else {
+            type = j.value("type", std::string("gcode"));
+            text = j.at("text").get<std::string>();
+            name = "host";
+        }
+        if (j.count("params")) {
+            for (auto p = j["params"].begin(); p != j["params"].end(); ++p) {
+                values[p.key()] = p.value().is_string() ? p.value().get<std::string>() : p.value().dump();
+            }
+        }
+        name = j.value("name", name + (type == "basic" ? ".bas" : ".nc"));
+        
+        // 展开 ${key} 占位符
+        std::string expanded;
+        size_t pos = 0;
+        while (true) {
+            size_t start = text.find("${", pos);
+            if (start == std::string::npos) break;
+            size_t end = text.find('}', start);
+            if (end == std::string::npos) break;
+            std::string key = text.substr(start + 2, end - start - 2);
+            auto v = values.find(key);
+            if (v == values.end()) {
+                Tango::Except::throw_exception("InvalidData", "Missing script parameter: " + key, "scriptLoad");
+            }
+            expanded += text.substr(pos, start - pos) + v->second;
+            pos = end + 1;
+        }
+        text = expanded + text.substr(pos);
+    } catch (json::exception& e) {
+        Tango::Except::throw_exception("JSONParseError", e.what(), "scriptLoad");
+    }
+    if (type != "basic" && type != "gcode") {
+        Tango::Except::throw_exception("InvalidData", "Script type must be basic or gcode", "scriptLoad");
+    }
+    if (script_running_) {
+        Tango::Except::throw_exception("ScriptBusy", "Current script is running or paused, call scriptStop first", "scriptLoad");
+    }
+    log_event("scriptLoad: " + type + " " + name + " (" + std::to_string(text.size()) + " bytes)");
+    
+    if (!sim_mode_) {
+        WORD filetype = (type == "basic") ? SCRIPT_FILETYPE_BASIC : SCRIPT_FILETYPE_GCODE;
+        check_error(SMC_CALL(smc_download_memfile, card_id_, text.c_str(), static_cast<uint32>(text.size()),
+                             name.c_str(), filetype), "scriptLoad_smc_download_memfile");
+        if (type == "gcode") {
+            check_error(SMC_CALL(smc_gcode_set_current_file, card_id_, name.c_str()), "scriptLoad_smc_gcode_set_current_file");
+        }
+    }
+    script_type_ = type;
+    script_name_ = name;
+    script_paused_ = false;
+    script_messages_.clear();
+    result_value_ = 0;
+}
+
+void MotionControllerDevice::scriptStart() {
+    check_connection();
+    if (script_type_.empty()) {
+        Tango::Except::throw_exception("ScriptNotLoaded", "No script loaded, call scriptLoad first", "scriptStart");
+    }
+    if (is_disabled_) {
+        Tango::Except::throw_exception("DISABLED", "Motion disabled by interlock", "scriptStart");
+    }
+    if (get_state() == Tango::FAULT) {
+        Tango::Except::throw_exception("FAULT", "Device in fault state, reset required", "scriptStart");
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (!moving_axes_.empty()) {
+            Tango::Except::throw_exception("AxisBusy", "Axes are moving under host control", "scriptStart");
+        }
+        note_motion_command();
+    }
+    log_event(std::string(script_paused_ ? "scriptResume: " : "scriptStart: ") + script_name_);
+    if (!sim_mode_) {
+        if (script_type_ == "basic") {
+            check_error(script_paused_ ? SMC_CALL(smc_basic_continue_run, card_id_) : SMC_CALL(smc_basic_run, card_id_),
+                        "scriptStart");
+        } else {
+            check_error(SMC_CALL(smc_gcode_start, card_id_), "scriptStart");
+        }
+        script_poll_kind_ = (script_type_ == "basic") ? 1 : 2;
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        script_running_ = true;
+        set_state(Tango::MOVING);
+        set_status("Running script " + script_name_);
+    }
+    script_paused_ = false;
+    result_value_ = 0;
+}
+
+void MotionControllerDevice::scriptPause() {
+    check_connection();
+    if (script_type_.empty()) {
+        Tango::Except::throw_exception("ScriptNotLoaded", "No script loaded", "scriptPause");
+    }
+    log_event("scriptPause: " + script_name_);
+    if (!sim_mode_) {
+        if (script_type_ == "basic") check_error(SMC_CALL(smc_basic_pause, card_id_), "scriptPause");
+        else check_error(SMC_CALL(smc_gcode_pause, card_id_), "scriptPause");
+    }
+    script_paused_ = true;
+    if (script_running_) set_status("Script paused: " + script_name_);
+    result_value_ = 0;
+}
+
+void MotionControllerDevice::scriptStop() {
+    check_connection();
+    if (script_type_.empty()) {
+        result_value_ = 0;
+        return;
+    }
+    log_event("scriptStop: " + script_name_);
+    if (!sim_mode_) {
+        if (script_type_ == "basic") check_error(SMC_CALL(smc_basic_stop, card_id_), "scriptStop");
+        else check_error(SMC_CALL(smc_gcode_stop, card_id_), "scriptStop");
+    }
+    script_paused_ = false;
+    script_poll_kind_ = 0;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (script_running_) {
+            script_running_ = false;
+            if (moving_axes_.empty() && get_state() == Tango::MOVING) {
+                set_state(Tango::STANDBY);
+                set_status("Ready - Script stopped");
+            }
+        }
+    }
+    result_value_ = 0;
+}
+
+Tango::DevString MotionControllerDevice::scriptStatus() {
+    json status;
+    status["type"] = script_type_;
+    status["name"] = script_name_;
+    status["running"] = script_running_;
+    status["paused"] = script_paused_;
+    if (!sim_mode_ && is_connected_ && !script_type_.empty()) {
+        WORD state = 0;
+        uint32 line = 0;
+        if (script_type_ == "basic") {
+            SMC_QUERY(smc_basic_state, card_id_, &state);
+            SMC_QUERY(smc_basic_current_line, card_id_, &line);
+            char buf[1024];
+            uint32 read = 0;
+            if (SMC_CALL(smc_basic_message, card_id_, buf, sizeof(buf), &read) == 0 && read > 0) {
+                script_messages_.append(buf, std::min<uint32>(read, sizeof(buf)));
+                if (script_messages_.size() > 4096) {
+                    script_messages_.erase(0, script_messages_.size() - 4096);
+                }
+            }
+        } else {
+            char cur_line[256] = {0};
+            WORD reason = 0;
+            SMC_QUERY(smc_gcode_state, card_id_, &state);
+            SMC_QUERY(smc_gcode_get_current_line, card_id_, &line, cur_line);
+            SMC_QUERY(smc_gcode_stop_reason, card_id_, &reason);
+            status["lineText"] = std::string(cur_line);
+            status["stopReason"] = reason;
+        }
+        status["state"] = state;
+        status["line"] = line;
+    }
+    status["messages"] = script_messages_;
+    return Tango::string_dup(status.dump().c_str());
+}
+
+Tango::DevString MotionControllerDevice::scriptTemplates() {
+    json list = json::object();
+    for (const auto &kv : script_templates_) {
+        list[kv.first]["type"] = kv.second.type;
+        list[kv.first]["defaults"] = kv.second.defaults;
+        list[kv.first]["text"] = kv.second.text;
+    }
+    return Tango::string_dup(list.dump().c_str());
+}
+
+// ========== Async command queue ==========
+namespace {
+// 从命令参数中解析涉及的轴；无法确定时返回空（视为占用全部轴）
+std::vector<short> async_command_axes(const std::string &name, const json &args) {
+    std::vector<short> axes;
+    if (name == "moveZero" || name == "stopMove") {
+        axes.push_back(args.is_array() ? args.at(0).get<short>() : args.get<short>());
+    } else if (name == "moveRelative" || name == "moveAbsolute" || name == "setMoveParameter") {
+        axes.push_back(args.at(0).get<short>());
+    } else if (name == "moveRelativeMulti" || name == "moveAbsoluteMulti") {
+        for (size_t i = 0; i < args.size(); i += 2) axes.push_back(args.at(i).get<short>());
+    } else if (name == "setPvts" || name == "movePvts") {
+        if (args.is_object() && args.count("axes")) axes = args["axes"].get<std::vector<short>>();
+    } else if (name == "setPvtsBinary") {
+        // 头部非法时返回空（占用全部轴），由 setPvtsBinary 执行时报错
+        size_t n = 0, axis = 0;
+        if (!pvt_binary_index(args.at(0).get<double>(), MAX_AXES, n) || args.size() < 2 + n) return {};
+        for (size_t i = 0; i < n; ++i) {
+            if (!pvt_binary_index(args.at(2 + i).get<double>(), MAX_AXES - 1, axis)) return {};
+            axes.push_back(static_cast<short>(axis));
+        }
+    }
+    return axes;
+}
+
+bool axes_overlap(const std::vector<short> &a, const std::vector<short> &b) {
+    if (a.empty() || b.empty()) return true;
+    for (short x : a) {
+        if (std::find(b.begin(), b.end(), x) != b.end()) return true;
+    }
+    return false;
+}
+
+std::string format_time(const std::chrono::system_clock::time_point &tp) {
+    auto time = std::chrono::system_clock::to_time_t(tp);
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+}  // namespace
+
+Tango::DevLong MotionControllerDevice::submitCommand(Tango::DevString argin) {
+    check_connection();
+    AsyncCommand cmd;
+    try {
+        json j = json::parse(argin);
+        cmd.name = j.at("cmd").get<std::string>();
+        json args = j.value("args", json());
+        static const std::set<std::string> kSupported = {
+            "moveZero", "moveRelative", "moveAbsolute", "moveRelativeMulti", "moveAbsoluteMulti",
+            "setPvts", "setPvtsBinary", "movePvts", "setMoveParameter", "stopMove"};
+        if (kSupported.count(cmd.name) == 0) {
+            Tango::Except::throw_exception("InvalidArgs", "Unsupported async command: " + cmd.name, "submitCommand");
+        }
+        cmd.axes = async_command_axes(cmd.name, args);
+        cmd.args = args.dump();
+    } catch (const json::exception &e) {
+        Tango::Except::throw_exception("JSONParseError", e.what(), "submitCommand");
+    }
+    
+    if (cmd.name == "stopMove") {
+        // 停止不排队：取消该轴尚未执行的命令后立即停止（smc_stop 不阻塞）
+        {
+            std::lock_guard<std::mutex> lock(async_mutex_);
+            cmd.id = async_next_id_++;
+            for (AsyncCommand &c : async_commands_) {
+                if (c.state == "queued" && axes_overlap(c.axes, cmd.axes)) {
+                    c.state = "cancelled";
+                    c.error = "Cancelled by stopMove (command " + std::to_string(cmd.id) + ")";
+                    c.finished = std::chrono::system_clock::now();
+                }
+            }
+        }
+        cmd.submitted = std::chrono::system_clock::now();
+        try {
+            stopMove(cmd.axes.at(0));
+            cmd.state = "done";
+        } catch (Tango::DevFailed &e) {
+            cmd.state = "failed";
+            cmd.error = e.errors[0].desc.in();
+        }
+        cmd.finished = std::chrono::system_clock::now();
+        std::lock_guard<std::mutex> lock(async_mutex_);
+        async_commands_.push_back(cmd);
+        async_dirty_ = true;
+        return cmd.id;
+    }
+    
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    cmd.id = async_next_id_++;
+    cmd.state = "queued";
+    cmd.submitted = std::chrono::system_clock::now();
+    async_commands_.push_back(cmd);
+    async_dirty_ = true;
+    async_cv_.notify_all();
+    log_event("Async command " + std::to_string(cmd.id) + " queued: " + cmd.name);
+    return cmd.id;
+}
+
+Tango::DevString MotionControllerDevice::commandStatus(Tango::DevLong command_id) {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    for (const AsyncCommand &c : async_commands_) {
+        if (c.id != command_id) continue;
+        json j;
+        j["id"] = c.id;
+        j["cmd"] = c.name;
+        j["state"] = c.state;
+        j["error"] = c.error;
+        j["submitted"] = format_time(c.submitted);
+        if (c.state == "done" || c.state == "failed" || c.state == "cancelled") {
+            j["finished"] = format_time(c.finished);
+            j["elapsedMs"] = std::chrono::duration<double, std::milli>(c.finished - c.submitted).count();
+        }
+        return Tango::string_dup(j.dump().c_str());
+    }
+    Tango::Except::throw_exception("InvalidArgs", "Unknown command id " + std::to_string(command_id), "commandStatus");
+    return nullptr;
+}
+
+std::string MotionControllerDevice::async_queue_json() {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    json arr = json::array();
+    for (const AsyncCommand &c : async_commands_) {
+        json j;
+        j["id"] = c.id;
+        j["cmd"] = c.name;
+        j["state"] = c.state;
+        if (!c.error.empty()) j["error"] = c.error;
+        arr.push_back(j);
+    }
+    return arr.dump();
+}
+
+void MotionControllerDevice::start_async_workers() {
+    stop_async_workers();
+    {
+        std::lock_guard<std::mutex> lock(async_mutex_);
+        async_stop_ = false;
+    }
+    for (int i = 0; i < ASYNC_WORKERS; ++i) {
+        async_workers_.emplace_back(&MotionControllerDevice::async_worker_loop, this);
+    }
+}
+
+void MotionControllerDevice::stop_async_workers() {
+    {
+        std::lock_guard<std::mutex> lock(async_mutex_);
+        async_stop_ = true;
+        for (AsyncCommand &c : async_commands_) {
+            if (c.state == "queued") {
+                c.state = "cancelled";
+                c.error = "Device shutting down";
+                c.finished = std::chrono::system_clock::now();
+            }
+        }
+    }
+    async_cv_.notify_all();
+    for (std::thread &t : async_workers_) {
+        if (t.joinable()) t.join();
+    }
+    async_workers_.clear();
+}
+
+void MotionControllerDevice::async_worker_loop() {
+    std::unique_lock<std::mutex> lock(async_mutex_);
+    while (!async_stop_) {
+        // 取第一个可执行的命令：与执行中的命令及更早排队的命令都不共用轴
+        auto next = async_commands_.end();
+        std::vector<const AsyncCommand*> blockers;
+        for (auto it = async_commands_.begin(); it != async_commands_.end(); ++it) {
+            if (it->state == "running") {
+                blockers.push_back(&*it);
+            } else if (it->state == "queued") {
+                bool blocked = false;
+                for (const AsyncCommand *b : blockers) {
+                    if (axes_overlap(b->axes, it->axes)) { blocked = true; break; }
+                }
+                if (!blocked) { next = it; break; }
+                blockers.push_back(&*it);
+            }
+        }
+        if (next == async_commands_.end()) {
+            async_cv_.wait(lock);
+            continue;
+        }
+        
+        next->state = "running";
+        std::string name = next->name, args = next->args;
+        std::vector<short> axes = next->axes;
+        long id = next->id;
+        async_dirty_ = true;
+        lock.unlock();
+        
+        std::string state = "done", error;
+        try {
+            if (name == "setPvts" || name == "setPvtsBinary") {
+                // 下发前需先停轴；等待停止在监视器外进行，期间 stopMove 等命令和事件推送不受阻塞
+                settle_axes_for_async(axes, name);
+            }
+            // 命令体共享 controller_logs_、result_value_、fault_state_、PVT 缓存和设备状态，
+            // 须与 CORBA 线程上的命令及另一工作线程串行
+            Tango::AutoTangoMonitor synch(this);
+            try {
+                execute_async(name, args);
+            } catch (Tango::DevFailed &e) {
+                state = "failed";
+                error = e.errors[0].desc.in();
+            } catch (const std::exception &e) {
+                state = "failed";
+                error = e.what();
+            }
+            log_event("Async command " + std::to_string(id) + " " + state + (error.empty() ? "" : ": " + error));
+        } catch (Tango::DevFailed &e) {
+            // 等待停轴超时，或获取监视器超时（如 Init 期间 delete_device 持锁等待本线程退出）
+            state = "failed";
+            error = e.errors[0].desc.in();
+        }
+        
+        lock.lock();
+        for (AsyncCommand &c : async_commands_) {
+            if (c.id == id) {
+                c.state = state;
+                c.error = error;
+                c.finished = std::chrono::system_clock::now();
+                break;
+            }
+        }
+        // 只裁剪已结束的旧记录
+        while (async_commands_.size() > ASYNC_HISTORY) {
+            const std::string &st = async_commands_.front().state;
+            if (st == "queued" || st == "running") break;
+            async_commands_.pop_front();
+        }
+        async_dirty_ = true;
+        async_cv_.notify_all();
+    }
+}
+
+// 异步 PVT 下发前的停轴：仅 smc_stop 在监视器内下发，停止完成由后台轮询快照判定，
+// 不在监视器内睡眠等待；超时即失败（与同步路径相同的 5 s 上限）
+void MotionControllerDevice::settle_axes_for_async(const std::vector<short> &axes, const std::string &origin) {
+    if (sim_mode_) return;
+    auto moving_axes = [&](const HardwareSnapshot &snap) {
+        std::vector<short> moving;
+        for (short axis = 0; axis < MAX_AXES; ++axis) {
+            bool wanted = axes.empty() || std::find(axes.begin(), axes.end(), axis) != axes.end();
+            if (wanted && !snap.done[axis]) moving.push_back(axis);
+        }
+        return moving;
+    };
+    HardwareSnapshot snap;
+    if (!read_snapshot(snap) || !snap.valid) return;   // 无快照时交由命令体内的同步检查
+    std::vector<short> moving = moving_axes(snap);
+    if (moving.empty()) return;
+    
+    uint64_t barrier = 0;
+    {
+        Tango::AutoTangoMonitor synch(this);
+        for (short axis : moving) {
+            WARN_STREAM << "[PVT] Axis " << axis << " is moving, stopping it before " << origin << std::endl;
+            SMC_CALL(smc_stop, card_id_, axis, 0);  // 减速停止
+        }
+        barrier = snapshot_version_.load() + 2;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (snapshot_version_.load() < barrier) continue;
+        if (read_snapshot(snap) && snap.valid && moving_axes(snap).empty()) return;
+    }
+    Tango::Except::throw_exception("AxisBusy", "Axes did not stop within 5 s", origin);
+}
+
+void MotionControllerDevice::execute_async(const std::string &name, const std::string &args_json) {
+    json args = json::parse(args_json);
+    auto to_array = [&args](Tango::DevVarDoubleArray &arr) {
+        std::vector<double> v = args.get<std::vector<double>>();
+        arr.length(static_cast<CORBA::ULong>(v.size()));
+        std::copy(v.begin(), v.end(), arr.get_buffer());
+    };
+    Tango::DevVarDoubleArray arr;
+    if (name == "moveZero") {
+        moveZero(args.is_array() ? args.at(0).get<short>() : args.get<short>());
+    } else if (name == "setPvts" || name == "movePvts") {
+        std::string text = args.dump();
+        if (name == "setPvts") setPvts(const_cast<char*>(text.c_str()));
+        else movePvts(const_cast<char*>(text.c_str()));
+    } else {
+        to_array(arr);
+        if (name == "moveRelative") moveRelative(&arr);
+        else if (name == "moveAbsolute") moveAbsolute(&arr);
+        else if (name == "moveRelativeMulti") moveRelativeMulti(&arr);
+        else if (name == "moveAbsoluteMulti") moveAbsoluteMulti(&arr);
+        else if (name == "setPvtsBinary") setPvtsBinary(&arr);
+        else if (name == "setMoveParameter") setMoveParameter(&arr);
+    }
+}
+
+void MotionControllerDevice::read_commandQueue(Tango::Attribute &attr) {
+    std::string queue_json = async_queue_json();
+    attr_commandQueue_read = Tango::string_dup(queue_json.c_str());
+    attr.set_value(&attr_commandQueue_read);
+}
+
+void MotionControllerDevice::setMoveParameter(const Tango::DevVarDoubleArray *argin) {
+    check_connection();
+    if (argin->length() < 6) {
+        Tango::Except::throw_exception("InvalidArgs", 
+            "Requires [axis_id, start_vel, max_vel, acc_time, dec_time, stop_vel]", "setMoveParameter");
+    }
+    short axis = (short)(*argin)[0];
+    double start_vel = (*argin)[1];
+    double max_vel = (*argin)[2];
+    double acc_time = (*argin)[3];
+    double dec_time = (*argin)[4];
+    double stop_vel = (*argin)[5];
+    
+    if (sim_mode_) {
+        // 模拟模式：只记录日志
+        log_event("Simulation: setMoveParameter axis " + std::to_string(axis) + 
+                  " start_vel=" + std::to_string(start_vel) + 
+                  " max_vel=" + std::to_string(max_vel));
+        result_value_ = 0;
+        return;
+    }
+    
+    DEBUG_STREAM << "[SMC] smc_set_profile_unit(card_id=" << card_id_ << ", axis=" << axis 
+              << ", start_vel=" << start_vel << ", max_vel=" << max_vel 
+              << ", acc_time=" << acc_time << ", dec_time=" << dec_time 
+              << ", stop_vel=" << stop_vel << ")" << std::endl;
+    short ret = SMC_CALL(smc_set_profile_unit, card_id_, axis, start_vel, max_vel, acc_time, dec_time, stop_vel);
+    DEBUG_STREAM << "[SMC] smc_set_profile_unit() returned: " << ret << std::endl;
+    check_error(ret, "setMoveParameter");
     result_value_ = 0;
 }
 
@@ -1000,7 +3008,7 @@ void MotionControllerDevice::setStructParameter(const Tango::DevVarDoubleArray *
     DEBUG_STREAM << "[SMC] smc_set_equiv(card_id=" << card_id_ << ", axis=" << axis 
               << ", equiv=" << equiv << " [step_angle=" << step_angle 
               << ", gear_ratio=" << gear_ratio << ", subdivision=" << subdivision << "])" << std::endl;
-    short ret = smc_set_equiv(card_id_, axis, equiv);
+    short ret = SMC_CALL(smc_set_equiv, card_id_, axis, equiv);
     DEBUG_STREAM << "[SMC] smc_set_equiv() returned: " << ret << std::endl;
     check_error(ret, "setStructParameter");
     result_value_ = 0;
@@ -1026,7 +3034,7 @@ void MotionControllerDevice::setAnalog(const Tango::DevVarDoubleArray *argin) {
     }
     
     DEBUG_STREAM << "[SMC] smc_set_da_output(card_id=" << card_id_ << ", channel=" << channel << ", value=" << value << ")" << std::endl;
-    short ret = smc_set_da_output(card_id_, channel, value);
+    short ret = SMC_CALL(smc_set_da_output, card_id_, channel, value);
     DEBUG_STREAM << "[SMC] smc_set_da_output() returned: " << ret << std::endl;
     check_error(ret, "setAnalog");
     if (channel < MAX_AD_CHANNELS) analog_out_value_[channel] = value;
@@ -1044,7 +3052,7 @@ Tango::DevShort MotionControllerDevice::checkMoveState(Tango::DevShort axis_id)
     }
     
     DEBUG_STREAM << "[SMC] smc_check_done(card_id=" << card_id_ << ", axis=" << axis_id << ")" << std::endl;
-    short state = smc_check_done(card_id_, axis_id);
+    short state = SMC_QUERY(smc_check_done, card_id_, axis_id);
     // smc_check_done 返回值: 0=运动中, 1=已停止
     DEBUG_STREAM << "[SMC] smc_check_done() returned: " << state << " (0=moving, 1=stopped)" << std::endl;
     return state;
@@ -1062,7 +3070,7 @@ Tango::DevBoolean MotionControllerDevice::readOrg(Tango::DevShort axis_id) {
     }
     
     // DEBUG_STREAM << "[SMC] smc_read_org_pin(card_id=" << card_id_ << ", axis=" << axis_id << ")" << std::endl;
-    short ret = smc_read_org_pin(card_id_, axis_id);
+    short ret = SMC_QUERY(smc_read_org_pin, card_id_, axis_id);
     // DEBUG_STREAM << "[SMC] smc_read_org_pin() returned: " << ret << std::endl;
     return (ret == 0);
 }
@@ -1082,11 +3090,11 @@ Tango::DevShort MotionControllerDevice::readEL(Tango::DevShort axis_id) {
     
     short pos_limit = 0, neg_limit = 0;
     // DEBUG_STREAM << "[SMC] smc_read_elp_pin(card_id=" << card_id_ << ", axis=" << axis_id << ")" << std::endl;
-    pos_limit = smc_read_elp_pin(card_id_, axis_id);
+    pos_limit = SMC_QUERY(smc_read_elp_pin, card_id_, axis_id);
     // DEBUG_STREAM << "[SMC] smc_read_elp_pin() returned: " << pos_limit << std::endl;
     DEBUG_STREAM << "[SMC] smc_read_eln_pin(card_id=" << card_id_ << ", axis=" << axis_id << ")" << std::endl;
     DEBUG_STREAM << "[SMC] smc_read_elp_pin() returned: " << pos_limit << std::endl;
-    neg_limit = smc_read_eln_pin(card_id_, axis_id);
+    neg_limit = SMC_QUERY(smc_read_eln_pin, card_id_, axis_id);
     DEBUG_STREAM << "[SMC] smc_read_eln_pin(card_id=" << card_id_ << ", axis=" << axis_id << ")" << std::endl;
     DEBUG_STREAM << "[SMC] smc_read_eln_pin() returned: " << neg_limit << std::endl;
     // Return: 0=none, 1=EL+, -1=EL-
@@ -1108,13 +3116,66 @@ Tango::DevDouble MotionControllerDevice::readPos(Tango::DevShort axis_id) {
     
     double pos = 0.0;
     DEBUG_STREAM << "[SMC] smc_get_position_unit(card_id=" << card_id_ << ", axis=" << axis_id << ")" << std::endl;
-    short ret = smc_get_position_unit(card_id_, axis_id, &pos);
+    short ret = SMC_CALL(smc_get_position_unit, card_id_, axis_id, &pos);
     DEBUG_STREAM << "[SMC] smc_get_position_unit() returned: " << ret << ", pos=" << pos << std::endl;
     check_error(ret, "readPos");
     if (axis_id < MAX_AXES) motor_pos_[axis_id] = pos;
     return pos;
 }
 
+// 批量读取轴状态：axis_mask 第 i 位为 1 表示需要轴 i（<=0 表示全部轴）。
+// 输出 [轴数, 快照时效(ms), 然后每轴6个值: 轴号, 位置, done(1=已停止), EL(0/1=EL+/-1=EL-), ORG(1/0), 伺服使能(1/0)]
+// EL/ORG 约定与 readEL/readOrg 相同；数据取自后台轮询快照，限位每周期刷新，原点/伺服为慢速组
+Tango::DevVarDoubleArray *MotionControllerDevice::readAxesSnapshot(Tango::DevLong axis_mask) {
+    check_connection();
+    const size_t kRecord = 6;
+    std::vector<short> axes;
+    for (short i = 0; i < MAX_AXES; i++) {
+        if (axis_mask <= 0 || (axis_mask & (1L << i))) axes.push_back(i);
+    }
+    
+    Tango::DevVarDoubleArray *result = new Tango::DevVarDoubleArray();
+    result->length(2 + axes.size() * kRecord);
+    (*result)[0] = static_cast<double>(axes.size());
+    (*result)[1] = 0.0;
+    
+    if (sim_mode_) {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        for (size_t k = 0; k < axes.size(); ++k) {
+            short axis = axes[k];
+            double loc = special_location_value_[axis];
+            double *rec = &(*result)[2 + k * kRecord];
+            rec[0] = axis;
+            rec[1] = motor_pos_[axis];
+            rec[2] = (moving_axes_.count(axis) != 0) ? 0.0 : 1.0;
+            rec[3] = (loc == 1 || loc == -1) ? loc : 0.0;
+            rec[4] = (loc == 0) ? 1.0 : 0.0;
+            rec[5] = 1.0;
+        }
+        return result;
+    }
+    
+    HardwareSnapshot snap;
+    if (!read_snapshot(snap) || !snap.valid) {
+        delete result;
+        Tango::Except::throw_exception("HardwareError", "Axis snapshot not available yet (poller starting or link down)",
+                                       "MotionControllerDevice::readAxesSnapshot");
+    }
+    (*result)[1] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - snap.stamp).count();
+    for (size_t k = 0; k < axes.size(); ++k) {
+        short axis = axes[k];
+        double *rec = &(*result)[2 + k * kRecord];
+        rec[0] = axis;
+        rec[1] = snap.position[axis];
+        rec[2] = snap.done[axis] ? 1.0 : 0.0;
+        // 限位取自轴IO状态位；原点/伺服引脚低电平有效，与 readOrg 一致
+        rec[3] = snap.el_pos[axis] ? 1.0 : (snap.el_neg[axis] ? -1.0 : 0.0);
+        rec[4] = (snap.org[axis] == 0) ? 1.0 : 0.0;
+        rec[5] = (snap.servo_on[axis] == 0) ? 1.0 : 0.0;
+    }
+    return result;
+}
+
 void MotionControllerDevice::setEncoderPosition(const Tango::DevVarDoubleArray *argin) {
     check_connection();
     if (argin->length() < 2) {
@@ -1134,7 +3195,7 @@ void MotionControllerDevice::setEncoderPosition(const Tango::DevVarDoubleArray *
     }
     
     DEBUG_STREAM << "[SMC] smc_set_encoder_unit(card_id=" << card_id_ << ", axis=" << axis << ", pos=" << pos << ")" << std::endl;
-    short ret = smc_set_encoder_unit(card_id_, axis, pos);
+    short ret = SMC_CALL(smc_set_encoder_unit, card_id_, axis, pos);
     DEBUG_STREAM << "[SMC] smc_set_encoder_unit() returned: " << ret << std::endl;
     check_error(ret, "setEncoderPosition");
     if (axis < MAX_AXES) motor_pos_[axis] = pos;
@@ -1157,7 +3218,7 @@ Tango::DevShort MotionControllerDevice::readIO(Tango::DevShort bitno) {
     
     // 使用 smc_read_outbit 读取单个输出位 (OUT0-OUT11)
     DEBUG_STREAM << "[SMC] smc_read_outbit(card_id=" << card_id_ << ", bitno=" << bitno << ")" << std::endl;
-    short hardware_value = smc_read_outbit(card_id_, bitno);
+    short hardware_value = SMC_QUERY(smc_read_outbit, card_id_, bitno);
     DEBUG_STREAM << "[SMC] smc_read_outbit() returned: " << hardware_value << std::endl;
     
     // OUT0-OUT11 是低电平有效（active low），需要反转硬件值得到逻辑值
@@ -1197,7 +3258,7 @@ void MotionControllerDevice::writeIO(const Tango::DevVarDoubleArray *argin) {
     // 使用 smc_write_outbit 写入单个输出位 (OUT0-OUT11)
     DEBUG_STREAM << "[SMC] smc_write_outbit(card_id=" << card_id_ << ", bitno=" << bitno 
                  << ", logical_value=" << value << ", hardware_value=" << hardware_value << ")" << std::endl;
-    short ret = smc_write_outbit(card_id_, bitno, hardware_value);
+    short ret = SMC_CALL(smc_write_outbit, card_id_, bitno, hardware_value);
     DEBUG_STREAM << "[SMC] smc_write_outbit() returned: " << ret << std::endl;
     check_error(ret, "writeIO");
 }
@@ -1215,7 +3276,7 @@ Tango::DevDouble MotionControllerDevice::readAD(Tango::DevShort channel) {
     
     double value = 0.0;
     // DEBUG_STREAM << "[SMC] smc_get_ain(card_id=" << card_id_ << ", channel=" << channel << ")" << std::endl;
-    value = smc_get_ain(card_id_, channel);
+    value = SMC_CALL(smc_get_ain, card_id_, channel);
     // DEBUG_STREAM << "[SMC] smc_get_ain() returned: " << value << std::endl;
     if (channel < MAX_AD_CHANNELS) analog_in_value_[channel] = value;
     return value;
@@ -1235,7 +3296,7 @@ void MotionControllerDevice::writeAD(const Tango::DevVarDoubleArray *argin) {
     }
 
     DEBUG_STREAM << "[SMC] smc_set_da_output(card_id=" << card_id_ << ", channel=" << channel << ", value=" << value << ")" << std::endl;
-    short ret = smc_set_da_output(card_id_, channel, value);
+    short ret = SMC_CALL(smc_set_da_output, card_id_, channel, value);
     DEBUG_STREAM << "[SMC] smc_set_da_output() returned: " << ret << std::endl;
     check_error(ret, "writeAD");
     if (channel < MAX_AD_CHANNELS) analog_out_value_[channel] = value;
@@ -1358,24 +3419,18 @@ void MotionControllerDevice::read_analogOutValue(Tango::Attribute &attr) {
 }
 
 void MotionControllerDevice::read_analogInValue(Tango::Attribute &attr) {
-    if (!sim_mode_) {
-        for (int i = 0; i < MAX_AD_CHANNELS; i++) {
-            DEBUG_STREAM << "[SMC] smc_get_ain(card_id=" << card_id_ << ", channel=" << i << ") [read_analogInValue]" << std::endl;
-            analog_in_value_[i] = smc_get_ain(card_id_, i);
-            DEBUG_STREAM << "[SMC] smc_get_ain() returned: " << analog_in_value_[i] << std::endl;
-        }
+    HardwareSnapshot snap;
+    if (!sim_mode_ && read_snapshot(snap) && snap.valid) {
+        analog_in_value_ = snap.ain;
     }
     // 模拟模式下返回缓存值
     attr.set_value(analog_in_value_.data(), MAX_AD_CHANNELS);
 }
 
 void MotionControllerDevice::read_genericIoInputValue(Tango::Attribute &attr) {
-    if (!sim_mode_) {
-        for (int i = 0; i < MAX_IO_CHANNELS; i++) {
-            DEBUG_STREAM << "[SMC] smc_read_inport(card_id=" << card_id_ << ", port=" << i << ") [read_genericIoInputValue]" << std::endl;
-            generic_io_value_[i] = smc_read_inport(card_id_, i);
-            DEBUG_STREAM << "[SMC] smc_read_inport() returned: " << generic_io_value_[i] << std::endl;
-        }
+    HardwareSnapshot snap;
+    if (!sim_mode_ && read_snapshot(snap) && snap.valid) {
+        generic_io_value_ = snap.inputs;
     }
     // 模拟模式下返回缓存值
     attr.set_value(generic_io_value_.data(), MAX_IO_CHANNELS);
@@ -1383,27 +3438,10 @@ void MotionControllerDevice::read_genericIoInputValue(Tango::Attribute &attr) {
 
 void MotionControllerDevice::read_specialLocationValue(Tango::Attribute &attr) {
     // Update special location values (limit/origin status)
-    if (!sim_mode_) {
+    HardwareSnapshot snap;
+    if (!sim_mode_ && read_snapshot(snap) && snap.valid) {
         for (int i = 0; i < MAX_AXES; i++) {
-            DEBUG_STREAM << "[SMC] smc_read_org_pin(card_id=" << card_id_ << ", axis=" << i << ") [read_specialLocationValue]" << std::endl;
-            short org = smc_read_org_pin(card_id_, i);
-            DEBUG_STREAM << "[SMC] smc_read_org_pin() returned: " << org << std::endl;
-            DEBUG_STREAM << "[SMC] smc_read_elp_pin(card_id=" << card_id_ << ", axis=" << i << ")" << std::endl;
-            short pos_lim = smc_read_elp_pin(card_id_, i);
-            DEBUG_STREAM << "[SMC] smc_read_elp_pin() returned: " << pos_lim << std::endl;
-            DEBUG_STREAM << "[SMC] smc_read_eln_pin(card_id=" << card_id_ << ", axis=" << i << ")" << std::endl;
-            short neg_lim = smc_read_eln_pin(card_id_, i);
-            DEBUG_STREAM << "[SMC] smc_read_eln_pin() returned: " << neg_lim << std::endl;
-            // -1: negative limit, 0: origin, 1: positive limit, 2: none
-            if (org == 1) {
-                special_location_value_[i] = 0;
-            } else if (pos_lim == 1) {
-                special_location_value_[i] = 1;
-            } else if (neg_lim == 1) {
-                special_location_value_[i] = -1;
-            } else {
-                special_location_value_[i] = 2;
-            }
+            special_location_value_[i] = special_location_of(snap.org[i], snap.el_pos[i], snap.el_neg[i]);
         }
     }
     // 模拟模式下返回缓存值 (默认为2=无特殊位置)
@@ -1424,6 +3462,28 @@ void MotionControllerDevice::read_resultValue(Tango::Attribute &attr) {
     attr.set_value(&attr_resultValue_read);
 }
 
+void MotionControllerDevice::read_smcCallStats(Tango::Attribute &attr) {
+    std::string stats = Common::CallStatsRegistry::instance().to_json();
+    attr_smcCallStats_read = Tango::string_dup(stats.c_str());
+    attr.set_value(&attr_smcCallStats_read);
+}
+
+void MotionControllerDevice::resetSmcCallStats() {
+    Common::CallStatsRegistry::instance().reset();
+    log_event("SMC call statistics reset");
+}
+
+Tango::DevString MotionControllerDevice::dumpSmcCallStats() {
+    std::string table = Common::CallStatsRegistry::instance().to_table();
+    INFO_STREAM << "[SMC] Call statistics:\n" << table << std::endl;
+    return Tango::string_dup(table.c_str());
+}
+
+void MotionControllerDevice::read_eventRate(Tango::Attribute &attr) {
+    attr_eventRate_read = event_rate_.load();
+    attr.set_value(&attr_eventRate_read);
+}
+
 void MotionControllerDevice::always_executed_hook() {
     // ========== 1. 自动重连机制 ==========
     if (!sim_mode_ && !is_connected_) {
@@ -1447,8 +3507,51 @@ void MotionControllerDevice::always_executed_hook() {
     // ========== 3. 状态机：轮询运动状态 ==========
     std::lock_guard<std::mutex> lock(state_mutex_);
     
+    // 已关闭并启动的连续插补列表执行完毕（run_state 2=停止）后释放坐标系，
+    // 否则 conti_open_ 只能由 contiStop 清除，多轴同步运动会一直被拒绝。运行状态由轮询周期采样
+    if (conti_open_ && conti_closed_ && conti_started_) {
+        short run_state = 2;
+        if (!sim_mode_) {
+            HardwareSnapshot snap;
+            bool fresh = read_snapshot(snap) && snap.valid && snapshot_version_.load() >= motion_snapshot_barrier_.load() &&
+                         snap.conti_crd == static_cast<int>(conti_crd_);
+            run_state = fresh ? snap.conti_run_state : -1;
+        }
+        if (run_state == 2) {
+            conti_open_ = false;
+            conti_poll_crd_ = -1;
+            log_event("Conti path on crd " + std::to_string(conti_crd_) + " finished, "
+                      + std::to_string(conti_segments_) + " segments");
+        }
+    }
+    
+    // 控制器脚本运行期间保持 MOVING，控制器报告程序停止后恢复。程序状态由轮询周期采样
+    // （启动指令之后的第二个快照前不采信停止状态，与运动完成判定一致）
+    if (script_running_) {
+        int script_state = 0;
+        if (!sim_mode_) {
+            HardwareSnapshot snap;
+            bool fresh = read_snapshot(snap) && snap.valid && snapshot_version_.load() >= motion_snapshot_barrier_.load() &&
+                         snap.script_kind != 0 && snap.script_kind == script_poll_kind_.load();
+            script_state = fresh ? snap.script_state : -1;
+        }
+        if (script_state == 0) {
+            script_running_ = false;
+            script_paused_ = false;
+            script_poll_kind_ = 0;
+            log_event("Script finished: " + script_name_);
+            if (moving_axes_.empty() && get_state() == Tango::MOVING) {
+                set_state(Tango::STANDBY);
+                set_status("Ready - Script finished");
+            }
+        } else if (get_state() == Tango::STANDBY) {
+            set_state(Tango::MOVING);
+        }
+    }
+    
     // 如果当前是 MOVING 状态，检查所有运动中的轴
-    if (get_state() == Tango::MOVING && !moving_axes_.empty()) {
+    // PVT流执行期间分块之间可能短暂停顿，由流线程结束后再判定运动完成
+    if (get_state() == Tango::MOVING && !moving_axes_.empty() && !pvt_stream_active_) {
         if (sim_mode_) {
             // 模拟模式：立即完成运动
             moving_axes_.clear();
@@ -1458,14 +3561,15 @@ void MotionControllerDevice::always_executed_hook() {
             return;
         }
         
-        // 真实模式：轮询硬件状态
+        // 真实模式：读取后台轮询快照（早于最近一次运动指令的快照不可用于判定完成）
+        HardwareSnapshot snap;
+        if (!read_snapshot(snap) || !snap.valid ||
+            snapshot_version_.load() < motion_snapshot_barrier_.load()) {
+            return;
+        }
         std::set<short> still_moving;
         for (short axis : moving_axes_) {
-            DEBUG_STREAM << "[SMC] smc_check_done(card_id=" << card_id_ << ", axis=" << axis << ") [always_executed_hook]" << std::endl;
-            short state = smc_check_done(card_id_, axis);
-            // smc_check_done 返回值: 0=运动中, 1=已停止
-            DEBUG_STREAM << "[SMC] smc_check_done() returned: " << state << " (0=moving, 1=stopped)" << std::endl;
-            if (state == 0) {  // 0 = still moving
+            if (axis >= 0 && axis < MAX_AXES && !snap.done[axis]) {  // still moving
                 still_moving.insert(axis);
             }
         }
@@ -1499,6 +3603,10 @@ void MotionControllerDevice::read_attr(Tango::Attribute &attr) {
     else if (attr_name == "specialLocationValue") read_specialLocationValue(attr);
     else if (attr_name == "axisStatus") read_axisStatus(attr);
     else if (attr_name == "resultValue") read_resultValue(attr);
+    else if (attr_name == "eventRate") read_eventRate(attr);
+    else if (attr_name == "commandQueue") read_commandQueue(attr);
+    else if (attr_name == "smcCallStats") read_smcCallStats(attr);
+    else if (attr_name == "latchedPositions") read_latchedPositions(attr);
 }
 
 void MotionControllerDevice::write_attr(Tango::WAttribute &attr) {
@@ -1563,12 +3671,80 @@ void MotionControllerDeviceClass::command_factory() {
         "moveAbsolute", static_cast<void (Tango::DeviceImpl::*)(const Tango::DevVarDoubleArray *)>(&MotionControllerDevice::moveAbsolute)));
     command_list.push_back(new Tango::TemplCommandIn<Tango::DevShort>(
         "stopMove", static_cast<void (Tango::DeviceImpl::*)(Tango::DevShort)>(&MotionControllerDevice::stopMove)));
+    command_list.push_back(new Tango::TemplCommandIn<const Tango::DevVarDoubleArray *>(
+        "moveRelativeMulti", static_cast<void (Tango::DeviceImpl::*)(const Tango::DevVarDoubleArray *)>(&MotionControllerDevice::moveRelativeMulti)));
+    command_list.push_back(new Tango::TemplCommandIn<const Tango::DevVarDoubleArray *>(
+        "moveAbsoluteMulti", static_cast<void (Tango::DeviceImpl::*)(const Tango::DevVarDoubleArray *)>(&MotionControllerDevice::moveAbsoluteMulti)));
     
     // ========== PVTS Commands ==========
     command_list.push_back(new Tango::TemplCommandIn<Tango::DevString>(
         "setPvts", static_cast<void (Tango::DeviceImpl::*)(Tango::DevString)>(&MotionControllerDevice::setPvts)));
     command_list.push_back(new Tango::TemplCommandIn<Tango::DevString>(
         "movePvts", static_cast<void (Tango::DeviceImpl::*)(Tango::DevString)>(&MotionControllerDevice::movePvts)));
+    command_list.push_back(new Tango::TemplCommandIn<const Tango::DevVarDoubleArray *>(
+        "setPvtsBinary", static_cast<void (Tango::DeviceImpl::*)(const Tango::DevVarDoubleArray *)>(&MotionControllerDevice::setPvtsBinary)));
+    command_list.push_back(new Tango::TemplCommandIn<Tango::DevString>(
+        "pvtStreamOpen", static_cast<void (Tango::DeviceImpl::*)(Tango::DevString)>(&MotionControllerDevice::pvtStreamOpen)));
+    command_list.push_back(new Tango::TemplCommandInOut<Tango::DevString, Tango::DevLong>(
+        "pvtStreamAppend", static_cast<Tango::DevLong (Tango::DeviceImpl::*)(Tango::DevString)>(&MotionControllerDevice::pvtStreamAppend)));
+    command_list.push_back(new Tango::TemplCommand(
+        "pvtStreamStop", static_cast<void (Tango::DeviceImpl::*)()>(&MotionControllerDevice::pvtStreamStop)));
+    command_list.push_back(new Tango::TemplCommandOut<Tango::DevString>(
+        "pvtStreamStatus", static_cast<Tango::DevString (Tango::DeviceImpl::*)()>(&MotionControllerDevice::pvtStreamStatus)));
+    
+    // ========== Conti Path Commands ==========
+    command_list.push_back(new Tango::TemplCommandIn<Tango::DevString>(
+        "contiOpen", static_cast<void (Tango::DeviceImpl::*)(Tango::DevString)>(&MotionControllerDevice::contiOpen)));
+    command_list.push_back(new Tango::TemplCommandInOut<Tango::DevString, Tango::DevLong>(
+        "contiAppend", static_cast<Tango::DevLong (Tango::DeviceImpl::*)(Tango::DevString)>(&MotionControllerDevice::contiAppend)));
+    command_list.push_back(new Tango::TemplCommand(
+        "contiStart", static_cast<void (Tango::DeviceImpl::*)()>(&MotionControllerDevice::contiStart)));
+    command_list.push_back(new Tango::TemplCommand(
+        "contiPause", static_cast<void (Tango::DeviceImpl::*)()>(&MotionControllerDevice::contiPause)));
+    command_list.push_back(new Tango::TemplCommandIn<Tango::DevShort>(
+        "contiStop", static_cast<void (Tango::DeviceImpl::*)(Tango::DevShort)>(&MotionControllerDevice::contiStop)));
+    command_list.push_back(new Tango::TemplCommandIn<Tango::DevDouble>(
+        "contiSetOverride", static_cast<void (Tango::DeviceImpl::*)(Tango::DevDouble)>(&MotionControllerDevice::contiSetOverride)));
+    command_list.push_back(new Tango::TemplCommandOut<Tango::DevString>(
+        "contiStatus", static_cast<Tango::DevString (Tango::DeviceImpl::*)()>(&MotionControllerDevice::contiStatus)));
+    
+    // ========== Position Compare Commands ==========
+    command_list.push_back(new Tango::TemplCommandIn<Tango::DevString>(
+        "hcmpConfig", static_cast<void (Tango::DeviceImpl::*)(Tango::DevString)>(&MotionControllerDevice::hcmpConfig)));
+    command_list.push_back(new Tango::TemplCommandIn<const Tango::DevVarDoubleArray *>(
+        "hcmpAddPoints", static_cast<void (Tango::DeviceImpl::*)(const Tango::DevVarDoubleArray *)>(&MotionControllerDevice::hcmpAddPoints)));
+    command_list.push_back(new Tango::TemplCommandIn<const Tango::DevVarDoubleArray *>(
+        "hcmpSetLinear", static_cast<void (Tango::DeviceImpl::*)(const Tango::DevVarDoubleArray *)>(&MotionControllerDevice::hcmpSetLinear)));
+    command_list.push_back(new Tango::TemplCommandIn<Tango::DevShort>(
+        "hcmpClear", static_cast<void (Tango::DeviceImpl::*)(Tango::DevShort)>(&MotionControllerDevice::hcmpClear)));
+    command_list.push_back(new Tango::TemplCommandInOut<Tango::DevShort, Tango::DevVarDoubleArray *>(
+        "hcmpStatus", static_cast<Tango::DevVarDoubleArray *(Tango::DeviceImpl::*)(Tango::DevShort)>(&MotionControllerDevice::hcmpStatus)));
+    
+    // ========== Position Latch Commands ==========
+    command_list.push_back(new Tango::TemplCommandIn<Tango::DevString>(
+        "latchArm", static_cast<void (Tango::DeviceImpl::*)(Tango::DevString)>(&MotionControllerDevice::latchArm)));
+    command_list.push_back(new Tango::TemplCommandInOut<Tango::DevShort, Tango::DevVarDoubleArray *>(
+        "latchRead", static_cast<Tango::DevVarDoubleArray *(Tango::DeviceImpl::*)(Tango::DevShort)>(&MotionControllerDevice::latchRead)));
+    
+    // ========== Controller Script Commands ==========
+    command_list.push_back(new Tango::TemplCommandIn<Tango::DevString>(
+        "scriptLoad", static_cast<void (Tango::DeviceImpl::*)(Tango::DevString)>(&MotionControllerDevice::scriptLoad)));
+    command_list.push_back(new Tango::TemplCommand(
+        "scriptStart", static_cast<void (Tango::DeviceImpl::*)()>(&MotionControllerDevice::scriptStart)));
+    command_list.push_back(new Tango::TemplCommand(
+        "scriptPause", static_cast<void (Tango::DeviceImpl::*)()>(&MotionControllerDevice::scriptPause)));
+    command_list.push_back(new Tango::TemplCommand(
+        "scriptStop", static_cast<void (Tango::DeviceImpl::*)()>(&MotionControllerDevice::scriptStop)));
+    command_list.push_back(new Tango::TemplCommandOut<Tango::DevString>(
+        "scriptStatus", static_cast<Tango::DevString (Tango::DeviceImpl::*)()>(&MotionControllerDevice::scriptStatus)));
+    command_list.push_back(new Tango::TemplCommandOut<Tango::DevString>(
+        "scriptTemplates", static_cast<Tango::DevString (Tango::DeviceImpl::*)()>(&MotionControllerDevice::scriptTemplates)));
+    
+    // ========== Async Command Queue ==========
+    command_list.push_back(new Tango::TemplCommandInOut<Tango::DevString, Tango::DevLong>(
+        "submitCommand", static_cast<Tango::DevLong (Tango::DeviceImpl::*)(Tango::DevString)>(&MotionControllerDevice::submitCommand)));
+    command_list.push_back(new Tango::TemplCommandInOut<Tango::DevLong, Tango::DevString>(
+        "commandStatus", static_cast<Tango::DevString (Tango::DeviceImpl::*)(Tango::DevLong)>(&MotionControllerDevice::commandStatus)));
     
     // ========== Parameter Configuration Commands ==========
     command_list.push_back(new Tango::TemplCommandIn<const Tango::DevVarDoubleArray *>(
@@ -1587,6 +3763,8 @@ void MotionControllerDeviceClass::command_factory() {
         "readEL", static_cast<Tango::DevShort (Tango::DeviceImpl::*)(Tango::DevShort)>(&MotionControllerDevice::readEL)));
     command_list.push_back(new Tango::TemplCommandInOut<Tango::DevShort, Tango::DevDouble>(
         "readPos", static_cast<Tango::DevDouble (Tango::DeviceImpl::*)(Tango::DevShort)>(&MotionControllerDevice::readPos)));
+    command_list.push_back(new Tango::TemplCommandInOut<Tango::DevLong, Tango::DevVarDoubleArray *>(
+        "readAxesSnapshot", static_cast<Tango::DevVarDoubleArray *(Tango::DeviceImpl::*)(Tango::DevLong)>(&MotionControllerDevice::readAxesSnapshot)));
     
     // ========== Encoder Commands ==========
     command_list.push_back(new Tango::TemplCommandIn<const Tango::DevVarDoubleArray *>(
@@ -1609,6 +3787,10 @@ void MotionControllerDeviceClass::command_factory() {
         "simSwitch", static_cast<void (Tango::DeviceImpl::*)(Tango::DevShort)>(&MotionControllerDevice::simSwitch)));
     command_list.push_back(new Tango::TemplCommandInOut<Tango::DevShort, Tango::DevString>(
         "errorParse", static_cast<Tango::DevString (Tango::DeviceImpl::*)(Tango::DevShort)>(&MotionControllerDevice::errorParse)));
+    command_list.push_back(new Tango::TemplCommand(
+        "resetSmcCallStats", static_cast<void (Tango::DeviceImpl::*)()>(&MotionControllerDevice::resetSmcCallStats)));
+    command_list.push_back(new Tango::TemplCommandOut<Tango::DevString>(
+        "dumpSmcCallStats", static_cast<Tango::DevString (Tango::DeviceImpl::*)()>(&MotionControllerDevice::dumpSmcCallStats)));
 }
 
 void MotionControllerDeviceClass::device_factory(const Tango::DevVarStringArray *dev_list) {
@@ -1638,7 +3820,10 @@ void MotionControllerDeviceClass::attribute_factory(std::vector<Tango::Attr *> &
     att_list.push_back(new Tango::Attr("faultState", Tango::DEV_STRING, Tango::READ));
     
     // Spectrum attributes
+    // 由事件线程按死区主动推送 change/archive 事件（不依赖 Tango 轮询检测）
     Tango::SpectrumAttr *motor_pos_attr = new Tango::SpectrumAttr("motorPos", Tango::DEV_DOUBLE, Tango::READ, MAX_AXES);
+    motor_pos_attr->set_change_event(true, false);
+    motor_pos_attr->set_archive_event(true, false);
     att_list.push_back(motor_pos_attr);
     
     att_list.push_back(new Tango::Attr("structParameter", Tango::DEV_STRING, Tango::READ));
@@ -1648,18 +3833,38 @@ void MotionControllerDeviceClass::attribute_factory(std::vector<Tango::Attr *> &
     att_list.push_back(analog_out_attr);
     
     Tango::SpectrumAttr *analog_in_attr = new Tango::SpectrumAttr("analogInValue", Tango::DEV_DOUBLE, Tango::READ, MAX_AD_CHANNELS);
+    analog_in_attr->set_change_event(true, false);
+    analog_in_attr->set_archive_event(true, false);
     att_list.push_back(analog_in_attr);
     
     Tango::SpectrumAttr *io_attr = new Tango::SpectrumAttr("genericIoInputValue", Tango::DEV_DOUBLE, Tango::READ, MAX_IO_CHANNELS);
+    io_attr->set_change_event(true, false);
+    io_attr->set_archive_event(true, false);
     att_list.push_back(io_attr);
     
     Tango::SpectrumAttr *special_loc_attr = new Tango::SpectrumAttr("specialLocationValue", Tango::DEV_DOUBLE, Tango::READ, MAX_AXES);
+    special_loc_attr->set_change_event(true, false);
+    special_loc_attr->set_archive_event(true, false);
     att_list.push_back(special_loc_attr);
     
     Tango::SpectrumAttr *axis_status_attr = new Tango::SpectrumAttr("axisStatus", Tango::DEV_BOOLEAN, Tango::READ, MAX_AXES);
+    axis_status_attr->set_change_event(true, false);
+    axis_status_attr->set_archive_event(true, false);
     att_list.push_back(axis_status_attr);
     
     att_list.push_back(new Tango::Attr("resultValue", Tango::DEV_SHORT, Tango::READ));
+    att_list.push_back(new Tango::Attr("eventRate", Tango::DEV_DOUBLE, Tango::READ));
+    
+    // 异步命令队列状态，有变化时推送 change 事件
+    Tango::Attr *command_queue_attr = new Tango::Attr("commandQueue", Tango::DEV_STRING, Tango::READ);
+    command_queue_attr->set_change_event(true, false);
+    att_list.push_back(command_queue_attr);
+    
+    att_list.push_back(new Tango::Attr("smcCallStats", Tango::DEV_STRING, Tango::READ));
+    
+    Tango::Attr *latched_attr = new Tango::Attr("latchedPositions", Tango::DEV_STRING, Tango::READ);
+    latched_attr->set_change_event(true, false);
+    att_list.push_back(latched_attr);
 }
 
 } // namespace MotionController
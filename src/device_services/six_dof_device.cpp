@@ -20,8 +20,12 @@ namespace SixDof {
 
 const double SixDofDevice::POS_LIMIT = 17.0;
 const double SixDofDevice::ROT_LIMIT = 4.0;
+const double SixDofDevice::LIMIT_SNAPSHOT_MAX_AGE_MS = 50.0;
 
 namespace {
+// 正解不收敛期间的状态文本，恢复收敛时据此判断是否还原
+const char *FK_STALE_STATUS = "Forward kinematics did not converge, sixFreedomPose is stale";
+
 struct AllowedStates {
     bool allow_unknown;
     bool allow_off;
@@ -48,6 +52,7 @@ const std::unordered_map<std::string, AllowedStates> kStateMatrix = {
     // 位姿运动
     {"movePoseRelative", {false, false, true,  false}},
     {"movePoseAbsolute", {false, false, true,  false}},
+    {"movePosePvt",      {false, false, true,  false}},
 
     // 复位 / 回零
     {"reset",            {false, true,  true,  true}},
@@ -62,6 +67,8 @@ const std::unordered_map<std::string, AllowedStates> kStateMatrix = {
     {"readEncoder",      {false, true,  true,  true}},
     {"readOrg",          {false, true,  true,  true}},
     {"readEL",           {false, true,  true,  true}},
+    {"checkPoseReachable", {true, true,  true,  true}},
+    {"queryMaxTravel",   {true,  true,  true,  true}},
 
     // 控制
     {"stop",             {false, true,  true,  true}},
@@ -89,6 +96,14 @@ SixDofDevice::SixDofDevice(Tango::DeviceClass *device_class, std::string &device
     dire_pos_.fill(0.0);
     six_freedom_pose_.fill(0.0);
     current_leg_lengths_.fill(0.0);
+    pvt_sample_interval_ = Common::TrajectoryPlanner::DEFAULT_PVT_INTERVAL;
+    sync_pvt_move_ = false;
+    pvt_cache_capacity_ = 16;
+    pvt_stream_chunk_ = 0;
+    pvt_cache_hits_ = 0;
+    pvt_cache_misses_ = 0;
+    geometry_hash_ = 0;
+    attr_pvtCacheStats_read = nullptr;
     lim_org_state_.fill(2);  // 2 = not at limit
     sdof_state_.fill(false); // false = idle
     
@@ -175,6 +190,27 @@ static double round_to_decimals(double value, int decimals) {
     return std::round(value * multiplier) / multiplier;
 }
 
+// 辅助函数：将6轴PVT表打包为 setPvtsBinary 参数
+// [axis_count, count, axes[6], time[count], pos[6][count], vel[6][count]]
+static std::vector<double> build_pvt_packed(const Common::SixAxisPVTTable &table) {
+    const size_t count = table.size();
+    std::vector<double> packed;
+    packed.reserve(2 + NUM_AXES + count * (1 + 2 * NUM_AXES));
+    packed.push_back(NUM_AXES);
+    packed.push_back(static_cast<double>(count));
+    for (int axis = 0; axis < NUM_AXES; ++axis) {
+        packed.push_back(axis);
+    }
+    packed.insert(packed.end(), table.time.begin(), table.time.end());
+    for (int axis = 0; axis < NUM_AXES; ++axis) {
+        packed.insert(packed.end(), table.position[axis].begin(), table.position[axis].end());
+    }
+    for (int axis = 0; axis < NUM_AXES; ++axis) {
+        packed.insert(packed.end(), table.velocity[axis].begin(), table.velocity[axis].end());
+    }
+    return packed;
+}
+
 SixDofDevice::~SixDofDevice() {
     delete_device();
 }
@@ -312,6 +348,7 @@ void SixDofDevice::init_device() {
 
 void SixDofDevice::delete_device() {
     stop_connection_monitor();
+    abort_pvt_stream();
     // 设备关闭前自动启用刹车（安全保护）
     if (brake_power_port_ >= 0 && brake_released_ && !sim_mode_) {
         INFO_STREAM << "[BrakeControl] Auto-engaging brake before device shutdown (safety)" << endl;
@@ -842,6 +879,8 @@ void SixDofDevice::init() {
         lim_org_state_[i] = 0;
     }
     six_freedom_pose_.fill(0.0);
+    fk_pose_ = Common::Pose();
+    fk_converged_ = true;
     self_check_result_ = -1;
     result_value_ = 0;
     set_state(Tango::ON);
@@ -959,12 +998,12 @@ void SixDofDevice::movePoseRelative(const Tango::DevVarDoubleArray *pose) {
     
     // Calculate inverse kinematics
     // Note: GUI sends angles in radians, but kinematics expects degrees
-    // const double rad_to_deg = 180.0 / M_PI;
+    const double rad_to_deg = 180.0 / M_PI;
     Common::Pose p;
     p.x = target_pose[0]; p.y = target_pose[1]; p.z = target_pose[2];
-    p.rx = target_pose[3];
-    p.ry = target_pose[4];
-    p.rz = target_pose[5];
+    p.rx = target_pose[3] * rad_to_deg;  // Convert radians to degrees
+    p.ry = target_pose[4] * rad_to_deg;
+    p.rz = target_pose[5] * rad_to_deg;
     
     std::array<double, 6> leg_lengths;
     if (!kinematics_->calculateInverseKinematics(p, leg_lengths)) {
@@ -986,10 +1025,14 @@ void SixDofDevice::movePoseRelative(const Tango::DevVarDoubleArray *pose) {
         }
         six_freedom_pose_ = target_pose;
         result_value_ = 0;
+    } else if (sync_pvt_move_) {
+        // 6轴时间同步的S曲线PVT：各腿同时起停
+        move_legs_synchronized(leg_lengths, "SixDofDevice::movePoseRelative");
     } else {
         std::cout << "get in motion" << endl;
         auto motion = get_motion_controller_proxy();
         if (motion) {
+            std::array<int, NUM_AXES> pulses;
             for (int i = 0; i < NUM_AXES; ++i) {
                 // 计算增量：目标腿长 - 当前存储的leg长度
                 double delta = leg_lengths[i] - current_leg_lengths_[i];
@@ -998,11 +1041,12 @@ void SixDofDevice::movePoseRelative(const Tango::DevVarDoubleArray *pose) {
                 std::cout << "current leg length " << current_leg_lengths_[i] << endl;
                 std::cout << "target leg length " << leg_lengths[i] << endl;
                 std::cout << "axis " << i << " delta: " << delta << endl;
-                int pulse = static_cast<int>(std::round(29793.103448275 * delta)); // 四舍五入到最接近的整数步数
-                std::cout << "axis " << i << " delta steps: " << pulse << endl;
-                // 使用相对运动
-                send_move_command(i, pulse, true);
-                sdof_state_[i] = true;
+                pulses[i] = static_cast<int>(std::round(29793.103448275 * delta)); // 四舍五入到最接近的整数步数
+                std::cout << "axis " << i << " delta steps: " << pulses[i] << endl;
+            }
+            // 使用相对运动，6腿一次下发、同时起停
+            send_move_command_multi(pulses, true);
+            for (int i = 0; i < NUM_AXES; ++i) {
                 // 更新存储的leg长度（保疙4位小数）
                 current_leg_lengths_[i] = round_to_decimals(leg_lengths[i], 4);
                 axis_pos_[i] = leg_lengths[i];
@@ -1067,21 +1111,26 @@ void SixDofDevice::movePoseAbsolute(const Tango::DevVarDoubleArray *pose) {
         }
         six_freedom_pose_ = target_pose;
         result_value_ = 0;
+    } else if (sync_pvt_move_) {
+        // 6轴时间同步的S曲线PVT：各腿同时起停
+        move_legs_synchronized(leg_lengths, "SixDofDevice::movePoseAbsolute");
     } else {
         std::cout << "get in motion" << endl;
         auto motion = get_motion_controller_proxy();
         if (motion) {
+            std::array<int, NUM_AXES> pulses;
             for (int i = 0; i < NUM_AXES; ++i) {
                 // TODO:这里不是计算相对增量，而是绝对增量：目标腿长 - 当前存储的leg长度.
                 double delta = leg_lengths[i] - current_leg_lengths_[i];
                 std::cout << "current leg length " << current_leg_lengths_[i] << endl;
                 std::cout << "target leg length " << leg_lengths[i] << endl;
                 std::cout << "axis " << i << " delta: " << delta << endl;
-                int pulse = static_cast<int>(std::round(29793.103448275 * delta)); // 四舍五入到最接近的整数步数
-                std::cout << "axis " << i << " delta steps: " << pulse << endl;
-                // 使用相对运动
-                send_move_command(i, pulse, false);
-                sdof_state_[i] = true;
+                pulses[i] = static_cast<int>(std::round(29793.103448275 * delta)); // 四舍五入到最接近的整数步数
+                std::cout << "axis " << i << " delta steps: " << pulses[i] << endl;
+            }
+            // 6腿一次下发、同时起停
+            send_move_command_multi(pulses, false);
+            for (int i = 0; i < NUM_AXES; ++i) {
                 // 更新存储的leg长度（保疙4位小数）
                 current_leg_lengths_[i] = round_to_decimals(leg_lengths[i], 4);
                 axis_pos_[i] = leg_lengths[i];
@@ -1168,6 +1217,8 @@ void SixDofDevice::sixMoveZero() {
         axis_pos_.fill(0.0);
         dire_pos_.fill(0.0);
         six_freedom_pose_.fill(0.0);
+        fk_pose_ = Common::Pose();
+        fk_converged_ = true;
         lim_org_state_.fill(0);  // At origin
         result_value_ = 0;
     } else {
@@ -1333,16 +1384,22 @@ void SixDofDevice::movePosePvt(Tango::DevString argin) {
     }
     
     try {
-        // 解析JSON输入: {"poses": [[x,y,z,rx,ry,rz],...], "times": [t0,t1,...], "velocities": [[vx,vy,vz,vrx,vry,vrz],...]}
+        // 解析JSON输入: {"poses": [[x,y,z,rx,ry,rz],...], "times": [t0,t1,...], "velocities": [[vx,vy,vz,wx,wy,wz],...]}
+        // velocities 为笛卡尔速度旋量：线速度 mm/s，角速度 rad/s（基座坐标系下的角速度矢量，非欧拉角速率）
+        // times 可选：不提供时按腿速度/加速度约束做时间最优参数化（TOPP），poses 视为路点
+        // "spline": true 时 poses/times 视为关键帧，按 "sampleInterval"(s，默认 pvtInterval) 做位姿样条加密
         nlohmann::json j = nlohmann::json::parse(argin);
         
-        if (j.count("poses") == 0 || j.count("times") == 0) {
+        if (j.count("poses") == 0) {
             Tango::Except::throw_exception("InvalidJSON",
-                "Required fields: poses, times", "movePosePvt");
+                "Required fields: poses", "movePosePvt");
         }
         
         auto poses = j["poses"].get<std::vector<std::array<double, 6>>>();
-        auto times = j["times"].get<std::vector<double>>();
+        std::vector<double> times;
+        if (j.count("times") > 0) {
+            times = j["times"].get<std::vector<double>>();
+        }
         
         // 速度可选，如果没有提供则自动计算
         std::vector<std::array<double, 6>> velocities;
@@ -1355,10 +1412,14 @@ void SixDofDevice::movePosePvt(Tango::DevString argin) {
             Tango::Except::throw_exception("InvalidData",
                 "At least 2 poses required", "movePosePvt");
         }
-        if (times.size() != static_cast<size_t>(count)) {
+        if (!times.empty() && times.size() != static_cast<size_t>(count)) {
             Tango::Except::throw_exception("InvalidData",
                 "times array size must match poses count", "movePosePvt");
         }
+        if (!velocities.empty() && velocities.size() != static_cast<size_t>(count)) {
+            Tango::Except::throw_exception("InvalidData",
+                "velocities array size must match poses count", "movePosePvt");
+        }
         
         // 验证所有姿态是否在范围内
         for (const auto& pose : poses) {
@@ -1368,31 +1429,131 @@ void SixDofDevice::movePosePvt(Tango::DevString argin) {
             }
         }
         
-        // 第一步：对每个姿态进行逆运动学计算，得到绝对腿长
-        const double rad_to_deg = 180.0 / M_PI;
-        std::vector<std::array<double, 6>> leg_lengths_abs_trajectory;  // 绝对腿长序列
+        // 相同请求（同一几何参数下）直接复用已规划的PVT表，跳过逆解/速度计算/打包
+        const bool use_spline = j.value("spline", false);
+        std::vector<int64_t> cache_key = make_pvt_cache_key(poses, times, velocities, use_spline,
+            j.value("sampleInterval", pvt_sample_interval_));
+        auto cached = pvt_cache_index_.find(cache_key);
+        if (cached != pvt_cache_index_.end()) {
+            ++pvt_cache_hits_;
+            pvt_cache_.splice(pvt_cache_.begin(), pvt_cache_, cached->second);
+            INFO_STREAM << "[PVT] Planned trajectory cache hit (" << pvt_cache_.front().points << " points)" << endl;
+            start_pose_pvt(pvt_cache_.front());
+            return;
+        }
+        ++pvt_cache_misses_;
         
+        // 第一步：批量逆运动学计算，得到绝对腿长（整条轨迹一次求解，不逐点输出日志）
+        const double rad_to_deg = 180.0 / M_PI;
+        Common::PoseBatch pose_batch;
+        pose_batch.resize(poses.size());
         for (size_t i = 0; i < poses.size(); ++i) {
-            Common::Pose p;
-            p.x = poses[i][0];
-            p.y = poses[i][1];
-            p.z = poses[i][2];
-            p.rx = poses[i][3] * rad_to_deg;
-            p.ry = poses[i][4] * rad_to_deg;
-            p.rz = poses[i][5] * rad_to_deg;
+            pose_batch.set(i, Common::Pose(poses[i][0], poses[i][1], poses[i][2],
+                                           poses[i][3] * rad_to_deg,
+                                           poses[i][4] * rad_to_deg,
+                                           poses[i][5] * rad_to_deg));
+        }
+        std::vector<std::array<double, 6>> leg_lengths_abs_trajectory(poses.size());  // 绝对腿长序列
+        std::vector<unsigned char> reachable(poses.size());
+        if (kinematics_->calculateInverseKinematicsBatch(pose_batch.view(),
+                leg_lengths_abs_trajectory.data(), reachable.data()) > 0) {
+            size_t bad = std::find(reachable.begin(), reachable.end(), 0) - reachable.begin();
+            Tango::Except::throw_exception("API_KinematicsError",
+                "Unreachable pose at index " + std::to_string(bad), "movePosePvt");
+        }
+        
+        // 对腿长进行4位小数舍入
+        for (auto& leg_lengths_abs : leg_lengths_abs_trajectory) {
+            for (int j = 0; j < NUM_AXES; ++j) {
+                leg_lengths_abs[j] = round_to_decimals(leg_lengths_abs[j], 4);
+            }
+        }
+        
+        if (use_spline) {
+            if (times.empty()) {
+                Tango::Except::throw_exception("InvalidData",
+                    "spline mode requires times", "movePosePvt");
+            }
+            std::vector<Common::Pose> keyframes(poses.size());
+            for (size_t i = 0; i < poses.size(); ++i) {
+                keyframes[i] = Common::Pose(pose_batch.x[i], pose_batch.y[i], pose_batch.z[i],
+                                            pose_batch.rx[i], pose_batch.ry[i], pose_batch.rz[i]);
+            }
+            Common::PoseSpline spline;
+            if (!spline.build(keyframes, times)) {
+                Tango::Except::throw_exception("InvalidData",
+                    "times must be strictly increasing", "movePosePvt");
+            }
             
-            std::array<double, 6> leg_lengths_abs;
-            if (!kinematics_->calculateInverseKinematics(p, leg_lengths_abs)) {
+            // 样条采样直接写入批量位姿，一次批量逆解
+            Common::PoseBatch samples;
+            Common::SixAxisPVTTable table;
+            std::vector<std::array<double, 6>> pose_velocities;
+            spline.sample(j.value("sampleInterval", pvt_sample_interval_), samples, table.time, &pose_velocities);
+            const size_t n = samples.size();
+            for (size_t i = 0; i < n; ++i) {
+                std::array<double, 6> pose_rad = {samples.x[i], samples.y[i], samples.z[i],
+                                                  samples.rx[i] / rad_to_deg,
+                                                  samples.ry[i] / rad_to_deg,
+                                                  samples.rz[i] / rad_to_deg};
+                if (!validate_pose(pose_rad)) {
+                    Tango::Except::throw_exception("API_OutOfRange",
+                        "Spline trajectory leaves pose limits at t=" + std::to_string(table.time[i]), "movePosePvt");
+                }
+            }
+            std::vector<std::array<double, 6>> sample_legs(n);
+            std::vector<unsigned char> sample_reachable(n);
+            if (kinematics_->calculateInverseKinematicsBatch(samples.view(), sample_legs.data(),
+                                                             sample_reachable.data()) > 0) {
+                size_t bad = std::find(sample_reachable.begin(), sample_reachable.end(), 0) - sample_reachable.begin();
                 Tango::Except::throw_exception("API_KinematicsError",
-                    "Unreachable pose at index " + std::to_string(i), "movePosePvt");
+                    "Unreachable spline pose at t=" + std::to_string(table.time[bad]), "movePosePvt");
             }
             
-            // 对腿长进行4位小数舍入
-            for (int j = 0; j < NUM_AXES; ++j) {
-                leg_lengths_abs[j] = round_to_decimals(leg_lengths_abs[j], 4);
+            // 腿速度由样条位姿变化率（欧拉角速率）经逆雅可比解析得到
+            for (int axis = 0; axis < NUM_AXES; ++axis) {
+                table.position[axis].resize(n);
+                table.velocity[axis].resize(n);
             }
-            
-            leg_lengths_abs_trajectory.push_back(leg_lengths_abs);
+            for (size_t i = 0; i < n; ++i) {
+                Common::Pose p(samples.x[i], samples.y[i], samples.z[i],
+                               samples.rx[i], samples.ry[i], samples.rz[i]);
+                std::array<double, 6> vel;
+                kinematics_->calculateLegVelocities(p, pose_velocities[i], vel);
+                for (int axis = 0; axis < NUM_AXES; ++axis) {
+                    table.position[axis][i] = round_to_decimals(sample_legs[i][axis], 4) -
+                                              leg_lengths_abs_trajectory[0][axis];
+                    table.velocity[axis][i] = vel[axis];
+                }
+            }
+            finish_pose_pvt(std::move(cache_key), table, leg_lengths_abs_trajectory.back(), poses.back());
+            INFO_STREAM << "[PVT] Spline trajectory started: " << count << " keyframes -> "
+                        << n << " points" << endl;
+            return;
+        }
+        
+        if (times.empty()) {
+            // 时间最优参数化：由路点和腿约束直接生成PVT表
+            std::vector<Common::Pose> waypoints(poses.size());
+            for (size_t i = 0; i < poses.size(); ++i) {
+                waypoints[i] = Common::Pose(pose_batch.x[i], pose_batch.y[i], pose_batch.z[i],
+                                            pose_batch.rx[i], pose_batch.ry[i], pose_batch.rz[i]);
+            }
+            Common::SixAxisPVTTable table;
+            double duration = Common::TrajectoryPlanner::planTimeOptimalPath(
+                *kinematics_, waypoints, leg_limits_, table, pvt_sample_interval_);
+            if (duration < 0.0) {
+                Tango::Except::throw_exception("API_KinematicsError",
+                    "Unreachable pose on trajectory path", "movePosePvt");
+            }
+            if (table.size() < 2) {
+                INFO_STREAM << "[PVT] All waypoints identical, no motion" << endl;
+                return;
+            }
+            finish_pose_pvt(std::move(cache_key), table, leg_lengths_abs_trajectory.back(), poses.back());
+            INFO_STREAM << "[PVT] Time-optimal trajectory started: " << table.size()
+                        << " points, " << duration << " s" << endl;
+            return;
         }
         
         // 第二步：转换为相对增量（相对于轨迹起点）
@@ -1406,10 +1567,23 @@ void SixDofDevice::movePosePvt(Tango::DevString argin) {
             leg_lengths_trajectory.push_back(leg_lengths_rel);
         }
         
-        // 计算每个轴的速度（如果没有提供）
+        // 计算每个轴的速度
         std::vector<std::array<double, 6>> leg_velocities;
-        if (velocities.empty()) {
-            // 根据位置差和时间差自动计算速度
+        if (!velocities.empty()) {
+            // 提供了速度旋量（关键帧+速度）：经铰点速度解析计算腿速度，稀疏关键帧即可得到平滑PVT
+            for (size_t i = 0; i < velocities.size(); ++i) {
+                std::array<double, 6> twist = velocities[i];
+                for (int axis = 3; axis < NUM_AXES; ++axis) {
+                    twist[axis] *= rad_to_deg;  // rad/s -> 度/s
+                }
+                Common::Pose p(pose_batch.x[i], pose_batch.y[i], pose_batch.z[i],
+                               pose_batch.rx[i], pose_batch.ry[i], pose_batch.rz[i]);
+                std::array<double, 6> vel;
+                kinematics_->calculateLegVelocitiesFromTwist(p, twist, vel);
+                leg_velocities.push_back(vel);
+            }
+        } else {
+            // 未提供速度：根据位置差和时间差用差分估算
             for (size_t i = 0; i < leg_lengths_trajectory.size(); ++i) {
                 std::array<double, 6> vel;
                 if (i == 0) {
@@ -1435,57 +1609,16 @@ void SixDofDevice::movePosePvt(Tango::DevString argin) {
             }
         }
         
-        // 构造JSON发送给运动控制器
-        nlohmann::json pvt_data;
-        pvt_data["axes"] = {0, 1, 2, 3, 4, 5};  // 所有6个轴
-        pvt_data["count"] = count;
-        pvt_data["time"] = times;
-        
-        // 转置：从[point][axis]到[axis][point]
-        std::vector<std::vector<double>> pos_by_axis(6);
-        std::vector<std::vector<double>> vel_by_axis(6);
+        // 组装共用时间基准的PVT表并下发
+        Common::SixAxisPVTTable table;
+        table.time = times;
         for (int axis = 0; axis < NUM_AXES; ++axis) {
             for (int i = 0; i < count; ++i) {
-                pos_by_axis[axis].push_back(leg_lengths_trajectory[i][axis]);
-                vel_by_axis[axis].push_back(leg_velocities[i][axis]);
+                table.position[axis].push_back(leg_lengths_trajectory[i][axis]);
+                table.velocity[axis].push_back(leg_velocities[i][axis]);
             }
         }
-        
-        pvt_data["pos"] = pos_by_axis;
-        pvt_data["vel"] = vel_by_axis;
-        
-        std::string pvt_json = pvt_data.dump();
-        
-        auto motion = get_motion_controller_proxy();
-        if (!motion) {
-            Tango::Except::throw_exception("API_ProxyError",
-                "Motion controller proxy not available", "movePosePvt");
-        }
-        
-        // 先下发PVT表
-        INFO_STREAM << "[PVT] Setting PVT table..." << endl;
-        Tango::DeviceData data_in;
-        data_in << Tango::string_dup(pvt_json.c_str());
-        motion->command_inout("setPvts", data_in);
-        
-        // 再启动运动
-        INFO_STREAM << "[PVT] Starting PVT motion..." << endl;
-        nlohmann::json move_cmd;
-        move_cmd["axes"] = {0, 1, 2, 3, 4, 5};
-        std::string move_json = move_cmd.dump();
-        Tango::DeviceData move_data;
-        move_data << Tango::string_dup(move_json.c_str());
-        motion->command_inout("movePvts", move_data);
-        
-        // 更新状态
-        for (int i = 0; i < NUM_AXES; ++i) {
-            sdof_state_[i] = true;
-            // 更新目标腿长为轨迹终点的绝对值
-            current_leg_lengths_[i] = leg_lengths_abs_trajectory.back()[i];
-        }
-        six_freedom_pose_ = poses.back();
-        set_state(Tango::MOVING);
-        result_value_ = 0;
+        finish_pose_pvt(std::move(cache_key), table, leg_lengths_abs_trajectory.back(), poses.back());
         
         INFO_STREAM << "[PVT] Trajectory motion started with " << count << " points" << endl;
         
@@ -1536,6 +1669,274 @@ void SixDofDevice::send_move_command(int axis, int position, bool relative) {
     }
 }
 
+// 6腿同步点位运动：一次 moveRelativeMulti/moveAbsoluteMulti 调用，控制器直线插补同时起停
+void SixDofDevice::send_move_command_multi(const std::array<int, NUM_AXES> &positions, bool relative) {
+    auto motion = get_motion_controller_proxy();
+    if (!motion) {
+        result_value_ = 1;
+        Tango::Except::throw_exception("API_ProxyError",
+            "Motion controller proxy not available", 
+            "SixDofDevice::send_move_command_multi");
+    }
+    
+    try {
+        Tango::DevVarDoubleArray move_params;
+        move_params.length(2 * NUM_AXES);
+        for (int i = 0; i < NUM_AXES; ++i) {
+            move_params[2 * i] = static_cast<double>(i);
+            move_params[2 * i + 1] = positions[i];
+        }
+        
+        Tango::DeviceData data_in;
+        data_in << move_params;
+        
+        std::string cmd = relative ? "moveRelativeMulti" : "moveAbsoluteMulti";
+        INFO_STREAM << "[DEBUG] send_move_command_multi: cmd=" << cmd << endl;
+        motion->command_inout(cmd.c_str(), data_in);
+        for (int i = 0; i < NUM_AXES; ++i) {
+            sdof_state_[i] = true;
+        }
+        set_state(Tango::MOVING);
+    } catch (Tango::DevFailed &e) {
+        result_value_ = 1;
+        ERROR_STREAM << "[DEBUG] send_move_command_multi: Failed, error: " << e.errors[0].desc << endl;
+        Tango::Except::re_throw_exception(e, 
+            "API_ProxyError", 
+            "Failed to send synchronized move command", 
+            "SixDofDevice::send_move_command_multi");
+    }
+}
+
+// 下发PVT表并启动6轴PVT运动（setPvts + movePvts）
+void SixDofDevice::send_pvt_table(const Common::SixAxisPVTTable &table, const std::string &origin) {
+    send_pvt_packed(build_pvt_packed(table), table.size(), origin);
+}
+
+// 以二进制形式下发已打包的PVT表并启动6轴PVT运动
+void SixDofDevice::send_pvt_packed(const std::vector<double> &packed, size_t points, const std::string &origin) {
+    auto motion = get_motion_controller_proxy();
+    if (!motion) {
+        Tango::Except::throw_exception("API_ProxyError",
+            "Motion controller proxy not available", origin.c_str());
+    }
+
+    // 先下发PVT表
+    INFO_STREAM << "[PVT] Setting PVT table (" << points << " points)..." << endl;
+    Tango::DevVarDoubleArray params;
+    params.length(packed.size());
+    std::copy(packed.begin(), packed.end(), params.get_buffer());
+    Tango::DeviceData data_in;
+    data_in << params;
+    motion->command_inout("setPvtsBinary", data_in);
+
+    // 再启动运动
+    INFO_STREAM << "[PVT] Starting PVT motion..." << endl;
+    nlohmann::json move_cmd;
+    move_cmd["axes"] = {0, 1, 2, 3, 4, 5};
+    std::string move_json = move_cmd.dump();
+    Tango::DeviceData move_data;
+    move_data << Tango::string_dup(move_json.c_str());
+    motion->command_inout("movePvts", move_data);
+}
+
+// movePosePvt 缓存键：几何哈希 + 模式 + 量化到 1e-6 的位姿/时间/速度
+std::vector<int64_t> SixDofDevice::make_pvt_cache_key(const std::vector<std::array<double, NUM_AXES>> &poses,
+                                                      const std::vector<double> &times,
+                                                      const std::vector<std::array<double, NUM_AXES>> &velocities,
+                                                      bool spline, double sample_interval) const {
+    const double quantum = 1e-6;
+    auto q = [quantum](double v) { return static_cast<int64_t>(std::llround(v / quantum)); };
+    std::vector<int64_t> key;
+    key.reserve(6 + NUM_AXES * (poses.size() + velocities.size()) + times.size());
+    key.push_back(geometry_hash_);
+    key.push_back(spline ? 1 : 0);
+    key.push_back(q(sample_interval));
+    key.push_back(static_cast<int64_t>(poses.size()));
+    key.push_back(static_cast<int64_t>(times.size()));
+    key.push_back(static_cast<int64_t>(velocities.size()));
+    for (const auto &pose : poses) {
+        for (double v : pose) key.push_back(q(v));
+    }
+    for (double t : times) key.push_back(q(t));
+    for (const auto &vel : velocities) {
+        for (double v : vel) key.push_back(q(v));
+    }
+    return key;
+}
+
+// 记录新规划的PVT表（LRU淘汰最久未用条目）并启动运动
+void SixDofDevice::finish_pose_pvt(std::vector<int64_t> key, const Common::SixAxisPVTTable &table,
+                                   const std::array<double, NUM_AXES> &final_legs,
+                                   const std::array<double, NUM_AXES> &final_pose) {
+    if (pvt_stream_chunk_ > 0 && table.size() > pvt_stream_chunk_) {
+        // 长轨迹分块流式下发，不进入缓存
+        stream_pvt_table(table, "movePosePvt");
+        mark_pose_pvt_started(final_legs, final_pose);
+        return;
+    }
+    
+    PvtCacheEntry entry;
+    entry.key = std::move(key);
+    entry.pvt_packed = build_pvt_packed(table);
+    entry.points = table.size();
+    entry.final_legs = final_legs;
+    entry.final_pose = final_pose;
+
+    if (pvt_cache_capacity_ == 0) {
+        start_pose_pvt(entry);
+        return;
+    }
+    pvt_cache_.push_front(std::move(entry));
+    pvt_cache_index_[pvt_cache_.front().key] = pvt_cache_.begin();
+    while (pvt_cache_.size() > pvt_cache_capacity_) {
+        pvt_cache_index_.erase(pvt_cache_.back().key);
+        pvt_cache_.pop_back();
+    }
+    start_pose_pvt(pvt_cache_.front());
+}
+
+void SixDofDevice::start_pose_pvt(const PvtCacheEntry &entry) {
+    send_pvt_packed(entry.pvt_packed, entry.points, "movePosePvt");
+    mark_pose_pvt_started(entry.final_legs, entry.final_pose);
+}
+
+void SixDofDevice::mark_pose_pvt_started(const std::array<double, NUM_AXES> &final_legs,
+                                         const std::array<double, NUM_AXES> &final_pose) {
+    for (int i = 0; i < NUM_AXES; ++i) {
+        sdof_state_[i] = true;
+        // 更新目标腿长为轨迹终点的绝对值
+        current_leg_lengths_[i] = final_legs[i];
+    }
+    six_freedom_pose_ = final_pose;
+    set_state(Tango::MOVING);
+    result_value_ = 0;
+}
+
+// 打开控制器侧PVT流，后台线程分块追加（控制器缓冲满时稍后重试），
+// 两侧内存占用都与分块大小有关而与轨迹总长无关
+void SixDofDevice::stream_pvt_table(const Common::SixAxisPVTTable &table, const std::string &origin) {
+    auto motion = get_motion_controller_proxy();
+    if (!motion) {
+        Tango::Except::throw_exception("API_ProxyError",
+            "Motion controller proxy not available", origin.c_str());
+    }
+    abort_pvt_stream();
+
+    nlohmann::json open_cmd;
+    open_cmd["axes"] = {0, 1, 2, 3, 4, 5};
+    std::string open_json = open_cmd.dump();
+    Tango::DeviceData open_data;
+    open_data << Tango::string_dup(open_json.c_str());
+    motion->command_inout("pvtStreamOpen", open_data);
+
+    INFO_STREAM << "[PVTStream] Streaming " << table.size() << " points in chunks of "
+                << pvt_stream_chunk_ << endl;
+    pvt_stream_abort_ = false;
+    pvt_stream_failed_ = false;
+    // 分块大小按值传入：流执行期间 sdofConfig 被重新应用也不影响本次分块
+    pvt_stream_thread_ = std::thread(&SixDofDevice::pvt_stream_loop, this,
+        std::make_shared<const Common::SixAxisPVTTable>(table), motion, pvt_stream_chunk_);
+}
+
+void SixDofDevice::pvt_stream_loop(std::shared_ptr<const Common::SixAxisPVTTable> table,
+                                   std::shared_ptr<Tango::DeviceProxy> motion, size_t chunk_size) {
+    const size_t total = table->size();
+    size_t appended = 0;
+    std::string error;
+    for (size_t begin = 0; begin < total && !pvt_stream_abort_ && error.empty(); begin += chunk_size) {
+        const size_t end = std::min(total, begin + chunk_size);
+        nlohmann::json chunk;
+        chunk["time"] = std::vector<double>(table->time.begin() + begin, table->time.begin() + end);
+        for (int axis = 0; axis < NUM_AXES; ++axis) {
+            chunk["pos"].push_back(std::vector<double>(table->position[axis].begin() + begin,
+                                                       table->position[axis].begin() + end));
+            chunk["vel"].push_back(std::vector<double>(table->velocity[axis].begin() + begin,
+                                                       table->velocity[axis].begin() + end));
+        }
+        chunk["last"] = (end == total);
+        std::string chunk_json = chunk.dump();
+
+        while (!pvt_stream_abort_) {
+            try {
+                Tango::DeviceData data_in;
+                data_in << Tango::string_dup(chunk_json.c_str());
+                motion->command_inout("pvtStreamAppend", data_in);
+                appended = end;
+                break;
+            } catch (Tango::DevFailed &e) {
+                if (e.errors.length() > 0 && std::string(e.errors[0].reason.in()) == "StreamBusy") {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    continue;
+                }
+                error = "PVT stream chunk upload failed at point " + std::to_string(begin) + ": " +
+                        (e.errors.length() > 0 ? e.errors[0].desc.in() : "");
+                ERROR_STREAM << "[PVTStream] " << error << endl;
+                break;
+            }
+        }
+    }
+
+    if (appended < total) {
+        // 未追加到最后一块：控制器侧已在执行部分路径并等待 last，必须显式停止流，
+        // 否则两台设备都停留在 MOVING
+        try {
+            motion->command_inout("pvtStreamStop");
+        } catch (Tango::DevFailed &e) {
+            ERROR_STREAM << "[PVTStream] pvtStreamStop failed: "
+                         << (e.errors.length() > 0 ? e.errors[0].desc.in() : "") << endl;
+        }
+        if (error.empty()) {
+            INFO_STREAM << "[PVTStream] Stream aborted after " << appended << "/" << total << " points" << endl;
+        }
+    }
+    if (!error.empty()) {
+        std::lock_guard<std::mutex> lock(pvt_stream_error_mutex_);
+        pvt_stream_error_ = error;
+        pvt_stream_failed_ = true;
+    }
+}
+
+void SixDofDevice::abort_pvt_stream() {
+    pvt_stream_abort_ = true;
+    if (pvt_stream_thread_.joinable()) {
+        pvt_stream_thread_.join();
+    }
+}
+
+// 以6轴时间同步的S曲线从当前腿长运动到目标腿长
+void SixDofDevice::move_legs_synchronized(const std::array<double, NUM_AXES> &leg_lengths,
+                                          const std::string &origin) {
+    std::array<double, NUM_AXES> displacements;
+    for (int i = 0; i < NUM_AXES; ++i) {
+        displacements[i] = leg_lengths[i] - current_leg_lengths_[i];
+    }
+
+    Common::SixAxisPVTTable table;
+    double duration = Common::TrajectoryPlanner::planSynchronizedSixAxis(
+        displacements, leg_limits_, table, pvt_sample_interval_);
+    if (duration <= 0.0) {
+        INFO_STREAM << "[PVT] Target equals current leg lengths, no motion" << endl;
+        return;
+    }
+
+    try {
+        send_pvt_table(table, origin);
+    } catch (Tango::DevFailed &e) {
+        result_value_ = 1;
+        Tango::Except::re_throw_exception(e, "API_ProxyError",
+            "Failed to execute synchronized PVT motion", origin.c_str());
+    }
+
+    for (int i = 0; i < NUM_AXES; ++i) {
+        sdof_state_[i] = true;
+        current_leg_lengths_[i] = round_to_decimals(leg_lengths[i], 4);
+        axis_pos_[i] = leg_lengths[i];
+    }
+    set_state(Tango::MOVING);
+    result_value_ = 0;
+    INFO_STREAM << "[PVT] Synchronized move started, duration " << duration << " s" << endl;
+}
+
 void SixDofDevice::simSwitch(Tango::DevShort mode) {
     bool was_sim_mode = sim_mode_;
     sim_mode_ = (mode != 0);
@@ -1639,6 +2040,84 @@ Tango::DevVarDoubleArray* SixDofDevice::readEncoder() {
     return result;
 }
 
+// 位姿可达性查询：输入 N 个位姿（6*N 个值，角度为弧度），不运动、不访问硬件
+// 输出 [是否全部可达(1/0), 最小腿长裕量(mm), 第一个不可达位姿的索引(-1表示无)]
+Tango::DevVarDoubleArray* SixDofDevice::checkPoseReachable(const Tango::DevVarDoubleArray *poses) {
+    check_state("checkPoseReachable");
+    if (poses->length() == 0 || poses->length() % NUM_AXES != 0) {
+        Tango::Except::throw_exception("API_InvalidArgs",
+            "Pose array length must be a multiple of 6", "SixDofDevice::checkPoseReachable");
+    }
+    if (!kinematics_) {
+        Tango::Except::throw_exception("API_KinematicsError",
+            "Kinematics not configured", "SixDofDevice::checkPoseReachable");
+    }
+
+    const double rad_to_deg = 180.0 / M_PI;
+    double min_margin = HUGE_VAL;
+    long first_bad = -1;
+    for (CORBA::ULong i = 0; i < poses->length(); i += NUM_AXES) {
+        std::array<double, NUM_AXES> pose;
+        for (int j = 0; j < NUM_AXES; ++j) {
+            pose[j] = (*poses)[i + j];
+        }
+        // 与 validate_pose 相同的软限位视为裕量为负
+        double margin = -1.0;
+        if (validate_pose(pose)) {
+            margin = kinematics_->calculateLegMargin(Common::Pose(pose[0], pose[1], pose[2],
+                pose[3] * rad_to_deg, pose[4] * rad_to_deg, pose[5] * rad_to_deg));
+        }
+        min_margin = std::min(min_margin, margin);
+        if (margin <= 0.0 && first_bad < 0) {
+            first_bad = i / NUM_AXES;
+        }
+    }
+
+    Tango::DevVarDoubleArray *result = new Tango::DevVarDoubleArray();
+    result->length(3);
+    (*result)[0] = first_bad < 0 ? 1.0 : 0.0;
+    (*result)[1] = min_margin;
+    (*result)[2] = static_cast<double>(first_bad);
+    return result;
+}
+
+// 沿方向的最大可行步长：从当前位姿出发，返回最大的 s 使 pose + s*direction 可达
+// direction 为 6 个值（mm / 弧度），同时受软限位 POS_LIMIT/ROT_LIMIT 约束
+Tango::DevDouble SixDofDevice::queryMaxTravel(const Tango::DevVarDoubleArray *direction) {
+    check_state("queryMaxTravel");
+    if (direction->length() != NUM_AXES) {
+        Tango::Except::throw_exception("API_InvalidArgs",
+            "Direction requires 6 values", "SixDofDevice::queryMaxTravel");
+    }
+    if (!kinematics_) {
+        Tango::Except::throw_exception("API_KinematicsError",
+            "Kinematics not configured", "SixDofDevice::queryMaxTravel");
+    }
+
+    // 软限位给出搜索上限
+    double max_step = HUGE_VAL;
+    for (int i = 0; i < NUM_AXES; ++i) {
+        double d = (*direction)[i];
+        if (d == 0.0) continue;
+        double limit = i < 3 ? POS_LIMIT : ROT_LIMIT;
+        double room = d > 0 ? limit - six_freedom_pose_[i] : limit + six_freedom_pose_[i];
+        max_step = std::min(max_step, std::max(0.0, room) / std::abs(d));
+    }
+    if (max_step == HUGE_VAL) {
+        Tango::Except::throw_exception("API_InvalidArgs",
+            "Direction must not be zero", "SixDofDevice::queryMaxTravel");
+    }
+
+    const double rad_to_deg = 180.0 / M_PI;
+    Common::Pose start(six_freedom_pose_[0], six_freedom_pose_[1], six_freedom_pose_[2],
+                       six_freedom_pose_[3] * rad_to_deg, six_freedom_pose_[4] * rad_to_deg,
+                       six_freedom_pose_[5] * rad_to_deg);
+    std::array<double, 6> dir = {(*direction)[0], (*direction)[1], (*direction)[2],
+                                 (*direction)[3] * rad_to_deg, (*direction)[4] * rad_to_deg,
+                                 (*direction)[5] * rad_to_deg};
+    return kinematics_->calculateMaxTravel(start, dir, max_step);
+}
+
 Tango::DevBoolean SixDofDevice::readOrg(Tango::DevShort axis) {
     check_state("readOrg");
     if (axis < 0 || axis >= NUM_AXES) {
@@ -1665,6 +2144,7 @@ Tango::DevShort SixDofDevice::readEL(Tango::DevShort axis) {
 void SixDofDevice::stop() {
     check_state("stop");
     log_event("Stop all axes");
+    abort_pvt_stream();
     
     if (!sim_mode_) {
         // 真实模式下，必须有控制器连接
@@ -1791,6 +2271,17 @@ void SixDofDevice::read_attr(Tango::Attribute &attr) {
     else if (attr_name == "resultValue") read_result_value(attr);
     else if (attr_name == "driverPowerStatus") read_driver_power_status(attr);
     else if (attr_name == "brakeStatus") read_brake_status(attr);
+    else if (attr_name == "pvtCacheStats") read_pvt_cache_stats(attr);
+}
+
+void SixDofDevice::read_pvt_cache_stats(Tango::Attribute &attr) {
+    nlohmann::json stats;
+    stats["hits"] = pvt_cache_hits_;
+    stats["misses"] = pvt_cache_misses_;
+    stats["size"] = pvt_cache_.size();
+    stats["capacity"] = pvt_cache_capacity_;
+    attr_pvtCacheStats_read = Tango::string_dup(stats.dump().c_str());
+    attr.set_value(&attr_pvtCacheStats_read);
 }
 
 void SixDofDevice::read_driver_power_status(Tango::Attribute &attr) {
@@ -1924,6 +2415,16 @@ void SixDofDevice::specific_self_check() {
 void SixDofDevice::always_executed_hook() {
     Common::StandardSystemDevice::always_executed_hook();
     
+    // 流线程追加失败：控制器侧流已停止，这里在设备线程中上报故障
+    if (pvt_stream_failed_.exchange(false)) {
+        std::lock_guard<std::mutex> lock(pvt_stream_error_mutex_);
+        result_value_ = 1;
+        alarm_state_ = pvt_stream_error_;
+        set_state(Tango::FAULT);
+        set_status(alarm_state_);
+        log_event(alarm_state_);
+    }
+    
     // LargeStroke-style: do not ping/reconnect in hook; only read connection_healthy_ (zero-wait).
     // 模拟模式：连接始终健康
     if (sim_mode_) {
@@ -1985,37 +2486,58 @@ void SixDofDevice::read_attr_hardware(std::vector<long> &/*attr_list*/) {
                 bool limit_triggered = false;
                 Tango::DevShort first_axis = -1;
                 Tango::DevShort first_el_state = 0;
+                // 一次 readAxesSnapshot 取回全部轴状态，代替逐轴 readEL
+                // 输出 [轴数, 时效ms, 每轴(轴号, 位置, done, EL, ORG, 伺服)]，EL: 0=none, 1=EL+, -1=EL-
+                // 快照读取失败或时效超过 LIMIT_SNAPSHOT_MAX_AGE_MS 时改为逐轴 readEL 直读引脚
+                const size_t kRecord = 6;
+                std::array<Tango::DevShort, NUM_AXES> el_states{};
+                std::array<bool, NUM_AXES> el_known{};
+                try {
+                    Tango::DeviceData data_in;
+                    data_in << static_cast<Tango::DevLong>((1 << NUM_AXES) - 1);
+                    Tango::DeviceData data_out = motion->command_inout("readAxesSnapshot", data_in);
+                    std::vector<double> snapshot;
+                    data_out >> snapshot;
+                    size_t records = snapshot.size() >= 2 ? static_cast<size_t>(snapshot[0]) : 0;
+                    if (records > 0 && snapshot[1] <= LIMIT_SNAPSHOT_MAX_AGE_MS) {
+                        for (size_t k = 0; k < records && 2 + (k + 1) * kRecord <= snapshot.size(); ++k) {
+                            int i = static_cast<int>(snapshot[2 + k * kRecord]);
+                            if (i < 0 || i >= NUM_AXES) continue;
+                            el_states[i] = static_cast<Tango::DevShort>(snapshot[2 + k * kRecord + 3]);
+                            el_known[i] = true;
+                        }
+                    }
+                } catch (...) {
+                    // 快照不可用，下面逐轴直读
+                }
                 for (int i = 0; i < NUM_AXES; ++i) {
+                    if (el_known[i]) continue;
                     try {
                         Tango::DeviceData data_in;
                         data_in << static_cast<Tango::DevShort>(i);
                         Tango::DeviceData data_out = motion->command_inout("readEL", data_in);
-                        Tango::DevShort el_state_raw;
-                        data_out >> el_state_raw;
-                        
-                        // 限位开关低电平有效：运动控制器已经处理了低电平有效逻辑
-                        // 运动控制器 readEL 返回值：
-                        //   1  = EL+（正限位触发）
-                        //   -1 = EL-（负限位触发）
-                        //   0  = 无限位触发
-                        // 直接使用运动控制器返回的值，不需要再反转
-                        Tango::DevShort el_state = el_state_raw;
-                        
-                        // readEL返回: 0=none, 1=EL+, -1=EL-
-                        if (el_state != 0) {
-                            limit_triggered = true;
-                            if (first_axis < 0) {
-                                first_axis = static_cast<Tango::DevShort>(i);
-                                first_el_state = el_state;
-                            }
-                            lim_org_state_[i] = el_state;
-                            INFO_STREAM << "[BrakeControl] Limit switch triggered on axis " << i 
-                                       << " (el_state=" << el_state << ")" << endl;
-                        } else if (lim_org_state_[i] == 1 || lim_org_state_[i] == -1) {
-                            lim_org_state_[i] = 2;
-                        }
+                        data_out >> el_states[i];
+                        el_known[i] = true;
                     } catch (...) {
-                        // 忽略单个轴读取失败
+                        // 读取失败时本周期不判定该轴限位
+                    }
+                }
+                for (int i = 0; i < NUM_AXES; ++i) {
+                    if (!el_known[i]) continue;
+                    // 限位开关低电平有效：运动控制器已经处理了低电平有效逻辑，直接使用返回值
+                    Tango::DevShort el_state = el_states[i];
+                    
+                    if (el_state != 0) {
+                        limit_triggered = true;
+                        if (first_axis < 0) {
+                            first_axis = static_cast<Tango::DevShort>(i);
+                            first_el_state = el_state;
+                        }
+                        lim_org_state_[i] = el_state;
+                        INFO_STREAM << "[BrakeControl] Limit switch triggered on axis " << i 
+                                   << " (el_state=" << el_state << ")" << endl;
+                    } else if (lim_org_state_[i] == 1 || lim_org_state_[i] == -1) {
+                        lim_org_state_[i] = 2;
                     }
                 }
                 // 如果检测到限位触发，立即启用刹车并停止运动
@@ -2149,14 +2671,43 @@ void SixDofDevice::update_axis_positions() {
 
 void SixDofDevice::update_pose_from_encoders() {
     update_axis_positions();
-    // NOTE: Forward kinematics (computing pose from leg lengths) is complex for Stewart platform
-    // and requires iterative numerical solving. Currently not implemented.
-    // The pose is updated from motion commands (movePoseAbsolute/Relative) instead.
-    // For single-axis moves, the pose cannot be directly computed from one leg length change,
-    // so six_freedom_pose_ is not updated in that case.
+    if (!kinematics_) {
+        return;
+    }
+    // 正运动学：由腿长（编码器）反求位姿，单轴运动、联锁停止后位姿同样正确。
+    // 以上一次的解作为初值（热启动），连续读取时通常2~3次迭代即可收敛。
+    const double deg_to_rad = M_PI / 180.0;
+    Common::Pose pose;
+    if (kinematics_->calculateForwardKinematics(axis_pos_, fk_pose_, pose)) {
+        fk_pose_ = pose;
+        six_freedom_pose_ = {pose.x, pose.y, pose.z,
+                             pose.rx * deg_to_rad, pose.ry * deg_to_rad, pose.rz * deg_to_rad};
+        if (!fk_converged_) {
+            fk_converged_ = true;
+            log_event("Forward kinematics converged again, sixFreedomPose updated");
+            if (get_status() == FK_STALE_STATUS) {
+                set_status(sim_mode_ ? "Simulation Mode" : "Connected");
+            }
+        }
+    } else {
+        // 不收敛（编码器数据异常或超出工作空间）：保留上一次位姿，下次从零位重新迭代。
+        // 每次读取 sixFreedomPose 都会重试，只在由收敛变为不收敛时记录，并通过状态文本提示位姿已过期
+        // （FAULT 时保留告警文本）
+        if (fk_converged_) {
+            fk_converged_ = false;
+            WARN_STREAM << "Forward kinematics did not converge, keeping last pose" << endl;
+            log_event(FK_STALE_STATUS);
+            if (get_state() != Tango::FAULT) {
+                set_status(FK_STALE_STATUS);
+            }
+        }
+        fk_pose_ = Common::Pose();
+    }
 }
 
 void SixDofDevice::configure_kinematics() {
+    // 几何与分块参数即将改变，先结束按旧参数进行的流式下发
+    abort_pvt_stream();
     if (sdof_config_.empty()) {
         WARN_STREAM << "sdofConfig is empty, using default kinematics parameter." << endl;
         return;
@@ -2210,6 +2761,21 @@ void SixDofDevice::configure_kinematics() {
             geom.max_leg_length = ll  + 40; // Heuristic
         }
 
+        // 同步PVT运动参数（6条腿共用同一组约束）
+        Common::AxisMotionLimits leg_limit(get_val("legMaxVelocity", 10.0),
+                                           get_val("legMaxAcceleration", 50.0),
+                                           get_val("legMaxJerk", 500.0));
+        leg_limits_.fill(leg_limit);
+        pvt_sample_interval_ = get_val("pvtInterval", Common::TrajectoryPlanner::DEFAULT_PVT_INTERVAL);
+        auto sync_it = obj.find("syncPvtMove");
+        sync_pvt_move_ = sync_it != obj.end() &&
+            (sync_it->is_boolean() ? sync_it->get<bool>() : get_val("syncPvtMove", 0.0) != 0.0);
+        pvt_cache_capacity_ = static_cast<size_t>(std::max(0.0, get_val("pvtCacheSize", 16.0)));
+        pvt_stream_chunk_ = static_cast<size_t>(std::max(0.0, get_val("pvtStreamChunk", 0.0)));
+        geometry_hash_ = static_cast<int64_t>(std::hash<std::string>()(sdof_config_));
+        pvt_cache_.clear();
+        pvt_cache_index_.clear();
+
         INFO_STREAM << "Kinematics configured: r1=" << geom.platform_radius 
                    << ", r2=" << geom.base_radius 
                    << ", hh=" << geom.initial_height << endl;
@@ -2303,6 +2869,9 @@ void SixDofDeviceClass::attribute_factory(std::vector<Tango::Attr *> &att_list)
     // Power control status attributes (NEW)
     att_list.push_back(new SixDofAttr("driverPowerStatus", Tango::DEV_BOOLEAN, Tango::READ));
     att_list.push_back(new SixDofAttr("brakeStatus", Tango::DEV_BOOLEAN, Tango::READ));
+    
+    // PVT规划缓存统计
+    att_list.push_back(new SixDofAttr("pvtCacheStats", Tango::DEV_STRING, Tango::READ));
 }
 
 void SixDofDeviceClass::command_factory() {
@@ -2335,6 +2904,8 @@ void SixDofDeviceClass::command_factory() {
         "movePoseRelative", static_cast<void (Tango::DeviceImpl::*)(const Tango::DevVarDoubleArray *)>(&SixDofDevice::movePoseRelative)));
     command_list.push_back(new Tango::TemplCommandIn<const Tango::DevVarDoubleArray *>(
         "movePoseAbsolute", static_cast<void (Tango::DeviceImpl::*)(const Tango::DevVarDoubleArray *)>(&SixDofDevice::movePoseAbsolute)));
+    command_list.push_back(new Tango::TemplCommandIn<Tango::DevString>(
+        "movePosePvt", static_cast<void (Tango::DeviceImpl::*)(Tango::DevString)>(&SixDofDevice::movePosePvt)));
     
     // Reset/Zero commands
     command_list.push_back(new Tango::TemplCommand(
@@ -2357,6 +2928,10 @@ void SixDofDeviceClass::command_factory() {
         "readOrg", static_cast<Tango::DevBoolean (Tango::DeviceImpl::*)(Tango::DevShort)>(&SixDofDevice::readOrg)));
     command_list.push_back(new Tango::TemplCommandInOut<Tango::DevShort, Tango::DevShort>(
         "readEL", static_cast<Tango::DevShort (Tango::DeviceImpl::*)(Tango::DevShort)>(&SixDofDevice::readEL)));
+    command_list.push_back(new Tango::TemplCommandInOut<const Tango::DevVarDoubleArray *, Tango::DevVarDoubleArray *>(
+        "checkPoseReachable", static_cast<Tango::DevVarDoubleArray * (Tango::DeviceImpl::*)(const Tango::DevVarDoubleArray *)>(&SixDofDevice::checkPoseReachable)));
+    command_list.push_back(new Tango::TemplCommandInOut<const Tango::DevVarDoubleArray *, Tango::DevDouble>(
+        "queryMaxTravel", static_cast<Tango::DevDouble (Tango::DeviceImpl::*)(const Tango::DevVarDoubleArray *)>(&SixDofDevice::queryMaxTravel)));
     
     // Control commands
     command_list.push_back(new Tango::TemplCommand(
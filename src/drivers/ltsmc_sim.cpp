@@ -0,0 +1,1276 @@
+/**
+ * @file ltsmc_sim.cpp
+ * @brief LTSMC 控制器仿真库（libLTSMC_sim）
+ *
+ * 导出与 LTSMC.h 相同的 C 接口（motion_controller_server 用到的全部 smc_* 函数），
+ * 用于无硬件条件下的端到端联调与压测：
+ * - 运动学模型：单轴/多轴直线插补按梯形（或三角形）速度曲线运行，PVT 按三次 Hermite 插值，
+ *   连续插补列表逐段执行（启用前瞻或拐角平滑时按段内恒速衔接），减速停止按停止时刻速度减速；
+ * - 通信延迟：每次调用在连接锁内等待 延迟+随机抖动，模拟单连接请求-应答串行；
+ * - IO：输出口回读、模拟量输出回环到同号输入，回零后 ORG 有效；
+ * - 锁存/比较输出：按周期合成锁存触发，比较点在轴位置越过时触发；
+ * - G代码：解释 G00/G01/G04/G28/G90/G91/F/M30 子集并在内部坐标系上执行，BASIC 只记录不解释。
+ *
+ * 环境变量（在 smc_board_init 时读取）：
+ *   LTSMC_SIM_LATENCY_US       每次调用的固定延迟，默认 300
+ *   LTSMC_SIM_JITTER_US        附加均匀随机抖动上限，默认 100
+ *   LTSMC_SIM_LATCH_PERIOD_MS  合成锁存触发周期，默认 0（不触发）
+ *   LTSMC_SIM_CONTI_SPACE      连续插补缓冲区容量（段），默认 5000
+ *
+ * 时间按调用时刻惰性推进，不创建后台线程。所有位置以用户单位（*_unit 接口）表示，
+ * smc_set_equiv 只记录当量不参与换算。
+ */
+
+#include "drivers/LTSMC.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int SIM_AXES = 16;
+const int SIM_CRDS = 2;              // 用户坐标系 0..1，G代码使用内部坐标系 SIM_CRDS
+const int SIM_LATCHES = 4;
+const int SIM_HCMPS = 4;
+const int SIM_IO_PORTS = 16;
+const int SIM_OUT_BITS = 64;
+const int SIM_AD_CHANNELS = 8;
+const size_t SIM_LATCH_FIFO = 256;
+const double SIM_EPS = 1e-9;
+
+// 返回码（与控制器手册的错误码含义保持一致）
+const short ERR_OK = 0;
+const short ERR_UNKNOWN = 1;
+const short ERR_PARAM = 2;
+const short ERR_BUSY = 4;
+const short ERR_NOT_INIT = 9;
+
+// ---------- 运动轨迹 ----------
+struct Track {
+    virtual ~Track() {}
+    virtual double duration() const = 0;
+    virtual double at(double t) const = 0;     // t 时刻沿轨迹的位移
+};
+
+// 长度 len 的梯形速度曲线，加减速时间按 max_vel 折算为加速度；距离不足时退化为三角形
+struct TrapezoidTrack : Track {
+    double acc, dec, vel, t_acc, t_const, t_dec, len;
+
+    TrapezoidTrack(double length, double max_vel, double tacc, double tdec) : len(length) {
+        vel = std::max(max_vel, SIM_EPS);
+        acc = tacc > SIM_EPS ? vel / tacc : 1e12;
+        dec = tdec > SIM_EPS ? vel / tdec : 1e12;
+        double ramp = vel * vel / (2 * acc) + vel * vel / (2 * dec);
+        if (ramp > len) {
+            vel = std::sqrt(2 * len * acc * dec / (acc + dec));
+        }
+        t_acc = vel / acc;
+        t_dec = vel / dec;
+        double cruise = len - vel * vel / (2 * acc) - vel * vel / (2 * dec);
+        t_const = cruise > 0 ? cruise / vel : 0.0;
+    }
+    double duration() const override { return t_acc + t_const + t_dec; }
+    double at(double t) const override {
+        if (t <= 0) return 0.0;
+        if (t < t_acc) return 0.5 * acc * t * t;
+        double s = 0.5 * acc * t_acc * t_acc;
+        t -= t_acc;
+        if (t < t_const) return s + vel * t;
+        s += vel * t_const;
+        t -= t_const;
+        if (t < t_dec) return s + vel * t - 0.5 * dec * t * t;
+        return len;
+    }
+};
+
+// 恒速段（前瞻/平滑模式下的连续插补段）
+struct ConstantTrack : Track {
+    double len, vel;
+    ConstantTrack(double length, double v) : len(length), vel(std::max(v, SIM_EPS)) {}
+    double duration() const override { return len / vel; }
+    double at(double t) const override { return std::min(len, std::max(0.0, t) * vel); }
+};
+
+// 纯延时段
+struct DelayTrack : Track {
+    double dt;
+    explicit DelayTrack(double delay) : dt(std::max(0.0, delay)) {}
+    double duration() const override { return dt; }
+    double at(double) const override { return 0.0; }
+};
+
+// 以初速度 v0 匀减速到0
+struct DecelTrack : Track {
+    double v0, dec;
+    DecelTrack(double v, double d) : v0(std::fabs(v)), dec(std::max(d, SIM_EPS)) {}
+    double duration() const override { return v0 / dec; }
+    double at(double t) const override {
+        t = std::min(std::max(t, 0.0), duration());
+        return v0 * t - 0.5 * dec * t * t;
+    }
+};
+
+// PVT：点间三次 Hermite 插值，位移相对首点
+struct PvtTrack : Track {
+    std::vector<double> time, pos, vel;
+    double duration() const override { return time.empty() ? 0.0 : time.back() - time.front(); }
+    double at(double t) const override {
+        if (time.size() < 2) return 0.0;
+        t += time.front();
+        if (t >= time.back()) return pos.back() - pos.front();
+        size_t k = std::upper_bound(time.begin(), time.end(), t) - time.begin();
+        if (k == 0) return 0.0;
+        size_t i = k - 1;
+        double h = time[k] - time[i];
+        if (h <= 0) return pos[k] - pos.front();
+        double u = (t - time[i]) / h;
+        double u2 = u * u, u3 = u2 * u;
+        double p = (2 * u3 - 3 * u2 + 1) * pos[i] + (u3 - 2 * u2 + u) * h * vel[i]
+                 + (-2 * u3 + 3 * u2) * pos[k] + (u3 - u2) * h * vel[k];
+        return p - pos.front();
+    }
+};
+
+struct Profile {
+    double min_vel = 0.0;
+    double max_vel = 100.0;
+    double tacc = 0.1;
+    double tdec = 0.1;
+    double stop_vel = 0.0;
+};
+
+struct Motion {
+    std::shared_ptr<const Track> track;
+    Clock::time_point t0;
+    double start = 0.0;
+    double scale = 1.0;                 // 轴位移 = scale * track.at(t)
+};
+
+struct Axis {
+    double pos = 0.0;
+    double equiv = 1.0;
+    Profile profile;
+    Motion motion;
+    bool moving = false;
+    int crd = -1;                        // 被连续插补坐标系占用时为坐标系号
+    WORD servo_level = 1;
+    WORD stop_reason = 0;
+    // smc_set_latch_mode 单轴锁存
+    bool latch_enabled = false;
+    bool latch_flag = false;
+    double latch_value = 0.0;
+    Clock::time_point latch_trigger;
+};
+
+struct ContiSegment {
+    bool delay = false;
+    double delay_time = 0.0;
+    std::vector<double> target;         // 绝对模式下 NaN 表示该轴不动
+    bool absolute = false;
+    Profile profile;
+    long mark = 0;
+};
+
+struct CrdState {
+    bool open = false;
+    bool closed = false;
+    bool running = false;
+    bool paused = false;
+    bool lookahead = false;
+    bool blend = false;
+    double override_ratio = 1.0;
+    Profile vector_profile;
+    std::vector<WORD> axes;
+    std::deque<ContiSegment> queue;
+    // 当前段
+    std::shared_ptr<const Track> track;
+    std::vector<double> seg_start;
+    std::vector<double> seg_delta;
+    double seg_len = 0.0;
+    double seg_clock = 0.0;              // 按倍率推进的段内时间
+    long current_mark = 0;
+};
+
+struct Latch {
+    WORD mode = 1;                       // 0=单次, 1=连续
+    std::vector<WORD> axes;
+    std::map<WORD, std::deque<double>> values;
+    bool armed = false;
+    Clock::time_point next_trigger;
+};
+
+struct Hcmp {
+    WORD axis = 0;
+    WORD mode = 0;
+    std::deque<double> points;
+    double liner_inc = 0.0;
+    long liner_count = 0;
+    long runned = 0;
+    double current = 0.0;
+};
+
+struct ScriptEngine {
+    std::map<std::string, std::string> files;
+    std::string gcode_file;
+    std::vector<std::string> gcode_lines;
+    WORD gcode_state = 0;                // 仿真约定：0=停止, 1=运行, 2=暂停
+    WORD basic_state = 0;
+    std::string basic_messages;
+};
+
+struct Card {
+    std::mutex mutex;
+    bool connected = false;
+    Clock::time_point last_update;
+    Axis axes[SIM_AXES];
+    CrdState crds[SIM_CRDS + 1];
+    Latch latches[SIM_LATCHES];
+    Hcmp hcmps[SIM_HCMPS];
+    WORD out_bits[SIM_OUT_BITS];
+    double da_output[SIM_AD_CHANNELS];
+    std::map<WORD, std::shared_ptr<const PvtTrack>> pvt_tables;
+    ScriptEngine script;
+
+    Card() {
+        std::fill(out_bits, out_bits + SIM_OUT_BITS, static_cast<WORD>(1));  // 输出低电平有效，上电为关
+        std::fill(da_output, da_output + SIM_AD_CHANNELS, 0.0);
+    }
+};
+
+struct SimConfig {
+    long latency_us = 300;
+    long jitter_us = 100;
+    long latch_period_ms = 0;
+    long conti_space = 5000;
+};
+
+SimConfig g_config;
+std::mutex g_cards_mutex;
+std::map<WORD, std::unique_ptr<Card>> g_cards;
+
+long env_long(const char *name, long fallback) {
+    const char *value = std::getenv(name);
+    return value && *value ? std::strtol(value, nullptr, 10) : fallback;
+}
+
+Card &card_of(WORD connect_no) {
+    std::lock_guard<std::mutex> lock(g_cards_mutex);
+    std::unique_ptr<Card> &slot = g_cards[connect_no];
+    if (!slot) slot.reset(new Card());
+    return *slot;
+}
+
+// 模拟一次网络往返
+void link_delay() {
+    long us = g_config.latency_us;
+    if (g_config.jitter_us > 0) {
+        thread_local std::mt19937 rng(std::random_device{}());
+        us += std::uniform_int_distribution<long>(0, g_config.jitter_us)(rng);
+    }
+    if (us > 0) std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+double seconds_between(Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration<double>(b - a).count();
+}
+
+void start_motion(Axis &axis, std::shared_ptr<const Track> track, double scale, Clock::time_point now) {
+    axis.motion.track = track;
+    axis.motion.t0 = now;
+    axis.motion.start = axis.pos;
+    axis.motion.scale = scale;
+    axis.moving = true;
+    axis.stop_reason = 0;
+}
+
+double axis_velocity(const Axis &axis, Clock::time_point now) {
+    if (!axis.moving || !axis.motion.track) return 0.0;
+    double t = seconds_between(axis.motion.t0, now);
+    const double h = 1e-4;
+    return axis.motion.scale * (axis.motion.track->at(t + h) - axis.motion.track->at(t - h)) / (2 * h);
+}
+
+// 开始坐标系队列中的下一段，返回 false 表示队列已空
+bool start_next_segment(Card &card, CrdState &crd) {
+    if (crd.queue.empty()) return false;
+    ContiSegment seg = crd.queue.front();
+    crd.queue.pop_front();
+    size_t n = crd.axes.size();
+    crd.seg_start.assign(n, 0.0);
+    crd.seg_delta.assign(n, 0.0);
+    crd.seg_clock = 0.0;
+    crd.current_mark = seg.mark;
+    if (seg.delay) {
+        for (size_t i = 0; i < n; ++i) crd.seg_start[i] = card.axes[crd.axes[i]].pos;
+        crd.seg_len = 0.0;
+        crd.track = std::make_shared<DelayTrack>(seg.delay_time);
+        return true;
+    }
+    double len2 = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double start = card.axes[crd.axes[i]].pos;
+        double target = i < seg.target.size() ? seg.target[i] : 0.0;
+        crd.seg_start[i] = start;
+        if (seg.absolute) {
+            crd.seg_delta[i] = std::isnan(target) ? 0.0 : target - start;
+        } else {
+            crd.seg_delta[i] = std::isnan(target) ? 0.0 : target;
+        }
+        len2 += crd.seg_delta[i] * crd.seg_delta[i];
+    }
+    crd.seg_len = std::sqrt(len2);
+    if (crd.lookahead || crd.blend) {
+        crd.track = std::make_shared<ConstantTrack>(crd.seg_len, seg.profile.max_vel);
+    } else {
+        crd.track = std::make_shared<TrapezoidTrack>(crd.seg_len, seg.profile.max_vel, seg.profile.tacc, seg.profile.tdec);
+    }
+    return true;
+}
+
+void release_crd_axes(Card &card, CrdState &crd) {
+    for (WORD a : crd.axes) {
+        if (card.axes[a].crd >= 0 && &card.crds[card.axes[a].crd] == &crd) card.axes[a].crd = -1;
+    }
+}
+
+void advance_crd(Card &card, CrdState &crd, double elapsed) {
+    if (!crd.running || crd.paused) return;
+    double budget = elapsed * crd.override_ratio;
+    while (true) {
+        if (!crd.track && !start_next_segment(card, crd)) {
+            if (crd.closed) {
+                crd.running = false;
+                release_crd_axes(card, crd);
+            }
+            return;
+        }
+        double remaining = crd.track->duration() - crd.seg_clock;
+        double step = std::min(budget, remaining);
+        crd.seg_clock += step;
+        budget -= step;
+        double s = crd.track->at(crd.seg_clock);
+        for (size_t i = 0; i < crd.axes.size(); ++i) {
+            double ratio = crd.seg_len > SIM_EPS ? s / crd.seg_len : 0.0;
+            card.axes[crd.axes[i]].pos = crd.seg_start[i] + crd.seg_delta[i] * ratio;
+        }
+        if (crd.seg_clock < crd.track->duration() - SIM_EPS) return;
+        crd.track.reset();
+        if (budget <= 0.0 && crd.queue.empty()) {
+            if (crd.closed) {
+                crd.running = false;
+                release_crd_axes(card, crd);
+            }
+            return;
+        }
+    }
+}
+
+void fire_hcmp(Card &card, double before[SIM_AXES]) {
+    for (Hcmp &cmp : card.hcmps) {
+        if (cmp.mode == 0 || cmp.points.empty()) continue;
+        double lo = std::min(before[cmp.axis], card.axes[cmp.axis].pos);
+        double hi = std::max(before[cmp.axis], card.axes[cmp.axis].pos);
+        while (!cmp.points.empty() && cmp.points.front() >= lo - SIM_EPS && cmp.points.front() <= hi + SIM_EPS) {
+            cmp.current = cmp.points.front();
+            cmp.points.pop_front();
+            ++cmp.runned;
+            if (cmp.liner_count > 1) {
+                --cmp.liner_count;
+                cmp.points.push_front(cmp.current + cmp.liner_inc);
+            } else {
+                cmp.liner_count = 0;
+            }
+            if (hi - lo < SIM_EPS) break;
+        }
+    }
+}
+
+void fire_latches(Card &card, Clock::time_point now) {
+    if (g_config.latch_period_ms <= 0) return;
+    auto period = std::chrono::milliseconds(g_config.latch_period_ms);
+    for (Latch &latch : card.latches) {
+        if (!latch.armed || now < latch.next_trigger) continue;
+        while (latch.next_trigger <= now) latch.next_trigger += period;
+        for (WORD a : latch.axes) {
+            std::deque<double> &fifo = latch.values[a];
+            if (fifo.size() < SIM_LATCH_FIFO) fifo.push_back(card.axes[a].pos);
+        }
+        if (latch.mode == 0) latch.armed = false;
+    }
+    for (Axis &axis : card.axes) {
+        if (axis.latch_enabled && !axis.latch_flag && now >= axis.latch_trigger) {
+            axis.latch_flag = true;
+            axis.latch_value = axis.pos;
+        }
+    }
+}
+
+void update_gcode_state(Card &card) {
+    CrdState &crd = card.crds[SIM_CRDS];
+    if (card.script.gcode_state == 1 && !crd.running) card.script.gcode_state = 0;
+}
+
+// 推进模型到当前时刻（调用方持有 card.mutex）
+void update(Card &card) {
+    Clock::time_point now = Clock::now();
+    double elapsed = seconds_between(card.last_update, now);
+    card.last_update = now;
+    double before[SIM_AXES];
+    for (int i = 0; i < SIM_AXES; ++i) before[i] = card.axes[i].pos;
+
+    for (Axis &axis : card.axes) {
+        if (!axis.moving) continue;
+        double t = seconds_between(axis.motion.t0, now);
+        double duration = axis.motion.track->duration();
+        axis.pos = axis.motion.start + axis.motion.scale * axis.motion.track->at(std::min(t, duration));
+        if (t >= duration) {
+            axis.moving = false;
+            axis.motion.track.reset();
+        }
+    }
+    for (CrdState &crd : card.crds) advance_crd(card, crd, std::max(0.0, elapsed));
+    update_gcode_state(card);
+    fire_hcmp(card, before);
+    fire_latches(card, now);
+}
+
+bool axis_busy(const Card &card, WORD axis) {
+    const Axis &a = card.axes[axis];
+    if (a.moving) return true;
+    if (a.crd >= 0) {
+        const CrdState &crd = card.crds[a.crd];
+        return crd.running && (crd.track || !crd.queue.empty());
+    }
+    return false;
+}
+
+// 统一入口：等待通信延迟并把模型推进到当前时刻，未连接时返回 not_connected
+#define SIM_ENTER_OR(connect_no, not_connected)                 \
+    Card &card = card_of(connect_no);                           \
+    std::lock_guard<std::mutex> card_lock(card.mutex);          \
+    link_delay();                                               \
+    if (!card.connected) return not_connected;                  \
+    update(card)
+#define SIM_ENTER(connect_no) SIM_ENTER_OR(connect_no, ERR_NOT_INIT)
+
+#define SIM_CHECK_AXIS(axis) \
+    if ((axis) >= SIM_AXES) return ERR_PARAM
+
+// G代码子集解释：每行生成一个连续插补段，段标号为行号（从1开始）
+short load_gcode(Card &card, const std::string &text) {
+    CrdState &crd = card.crds[SIM_CRDS];
+    crd = CrdState();
+    crd.open = true;
+    crd.closed = true;
+    for (WORD a = 0; a < 6; ++a) crd.axes.push_back(a);
+    card.script.gcode_lines.clear();
+    std::istringstream in(text);
+    std::string line;
+    bool absolute = true;
+    double feed = 600.0;
+    long line_no = 0;
+    const std::string letters = "XYZABC";
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        card.script.gcode_lines.push_back(line);
+        ++line_no;
+        std::istringstream words(line);
+        std::string word;
+        ContiSegment seg;
+        seg.target.assign(6, std::numeric_limits<double>::quiet_NaN());
+        seg.mark = line_no;
+        bool move = false, home = false, dwell = false, end = false;
+        double dwell_ms = 0.0;
+        while (words >> word) {
+            char code = static_cast<char>(std::toupper(static_cast<unsigned char>(word[0])));
+            double value = std::atof(word.c_str() + 1);
+            if (code == 'G') {
+                int g = static_cast<int>(value);
+                if (g == 0 || g == 1) move = true;
+                else if (g == 4) dwell = true;
+                else if (g == 28) home = true;
+                else if (g == 90) absolute = true;
+                else if (g == 91) absolute = false;
+            } else if (code == 'M') {
+                if (static_cast<int>(value) == 2 || static_cast<int>(value) == 30) end = true;
+            } else if (code == 'F') {
+                feed = value;
+            } else if (code == 'P') {
+                dwell_ms = value;
+            } else {
+                size_t idx = letters.find(code);
+                if (idx != std::string::npos) seg.target[idx] = home ? 0.0 : value;
+            }
+        }
+        if (end) break;
+        if (dwell) {
+            seg.delay = true;
+            seg.delay_time = dwell_ms / 1000.0;
+        } else if (move || home) {
+            seg.absolute = home || absolute;
+            seg.profile.max_vel = feed / 60.0;
+        } else {
+            continue;
+        }
+        crd.queue.push_back(seg);
+    }
+    return ERR_OK;
+}
+
+}  // namespace
+
+extern "C" {
+
+// ---------- 连接 ----------
+short smc_board_init(WORD ConnectNo, WORD, char *, DWORD) {
+    g_config.latency_us = std::max(0L, env_long("LTSMC_SIM_LATENCY_US", 300));
+    g_config.jitter_us = std::max(0L, env_long("LTSMC_SIM_JITTER_US", 100));
+    g_config.latch_period_ms = std::max(0L, env_long("LTSMC_SIM_LATCH_PERIOD_MS", 0));
+    g_config.conti_space = std::max(1L, env_long("LTSMC_SIM_CONTI_SPACE", 5000));
+    Card &card = card_of(ConnectNo);
+    std::lock_guard<std::mutex> lock(card.mutex);
+    link_delay();
+    card.connected = true;
+    card.last_update = Clock::now();
+    return ERR_OK;
+}
+
+short smc_board_close(WORD ConnectNo) {
+    SIM_ENTER(ConnectNo);
+    card.connected = false;
+    return ERR_OK;
+}
+
+// ---------- 参数 ----------
+short smc_set_equiv(WORD ConnectNo, WORD axis, double equiv) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    if (equiv <= 0) return ERR_PARAM;
+    card.axes[axis].equiv = equiv;
+    return ERR_OK;
+}
+
+short smc_set_profile_unit(WORD ConnectNo, WORD axis, double Min_Vel, double Max_Vel, double Tacc, double Tdec, double Stop_Vel) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    if (Max_Vel <= 0 || Tacc < 0 || Tdec < 0) return ERR_PARAM;
+    Profile &p = card.axes[axis].profile;
+    p.min_vel = Min_Vel;
+    p.max_vel = Max_Vel;
+    p.tacc = Tacc;
+    p.tdec = Tdec;
+    p.stop_vel = Stop_Vel;
+    return ERR_OK;
+}
+
+short smc_get_profile_unit(WORD ConnectNo, WORD axis, double *Min_Vel, double *Max_Vel, double *Tacc, double *Tdec, double *Stop_Vel) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    const Profile &p = card.axes[axis].profile;
+    if (Min_Vel) *Min_Vel = p.min_vel;
+    if (Max_Vel) *Max_Vel = p.max_vel;
+    if (Tacc) *Tacc = p.tacc;
+    if (Tdec) *Tdec = p.tdec;
+    if (Stop_Vel) *Stop_Vel = p.stop_vel;
+    return ERR_OK;
+}
+
+short smc_set_vector_profile_unit(WORD ConnectNo, WORD Crd, double Min_Vel, double Max_Vel, double Tacc, double Tdec, double Stop_Vel) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS || Max_Vel <= 0) return ERR_PARAM;
+    Profile &p = card.crds[Crd].vector_profile;
+    p.min_vel = Min_Vel;
+    p.max_vel = Max_Vel;
+    p.tacc = Tacc;
+    p.tdec = Tdec;
+    p.stop_vel = Stop_Vel;
+    return ERR_OK;
+}
+
+// ---------- 点位与插补 ----------
+short smc_pmove_unit(WORD ConnectNo, WORD axis, double Dist, WORD posi_mode) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    if (axis_busy(card, axis)) return ERR_BUSY;
+    Axis &a = card.axes[axis];
+    double delta = posi_mode ? Dist - a.pos : Dist;
+    if (std::fabs(delta) < SIM_EPS) return ERR_OK;
+    start_motion(a, std::make_shared<TrapezoidTrack>(std::fabs(delta), a.profile.max_vel, a.profile.tacc, a.profile.tdec),
+                 delta > 0 ? 1.0 : -1.0, Clock::now());
+    return ERR_OK;
+}
+
+short smc_line_unit(WORD ConnectNo, WORD Crd, WORD AxisNum, WORD *AxisList, double *Dist, WORD posi_mode) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS || AxisNum == 0 || !AxisList || !Dist) return ERR_PARAM;
+    std::vector<double> delta(AxisNum);
+    double len2 = 0.0;
+    for (WORD i = 0; i < AxisNum; ++i) {
+        SIM_CHECK_AXIS(AxisList[i]);
+        if (axis_busy(card, AxisList[i])) return ERR_BUSY;
+        delta[i] = posi_mode ? Dist[i] - card.axes[AxisList[i]].pos : Dist[i];
+        len2 += delta[i] * delta[i];
+    }
+    double len = std::sqrt(len2);
+    if (len < SIM_EPS) return ERR_OK;
+    const Profile &vp = card.crds[Crd].vector_profile;
+    auto track = std::make_shared<TrapezoidTrack>(len, vp.max_vel, vp.tacc, vp.tdec);
+    Clock::time_point now = Clock::now();
+    for (WORD i = 0; i < AxisNum; ++i) {
+        start_motion(card.axes[AxisList[i]], track, delta[i] / len, now);
+    }
+    return ERR_OK;
+}
+
+short smc_home_move(WORD ConnectNo, WORD axis) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    if (axis_busy(card, axis)) return ERR_BUSY;
+    Axis &a = card.axes[axis];
+    if (std::fabs(a.pos) < SIM_EPS) return ERR_OK;
+    start_motion(a, std::make_shared<TrapezoidTrack>(std::fabs(a.pos), a.profile.max_vel, a.profile.tacc, a.profile.tdec),
+                 a.pos > 0 ? -1.0 : 1.0, Clock::now());
+    return ERR_OK;
+}
+
+short smc_stop(WORD ConnectNo, WORD axis, WORD stop_mode) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    Axis &a = card.axes[axis];
+    if (a.crd >= 0) {
+        CrdState &crd = card.crds[a.crd];
+        crd.queue.clear();
+        crd.track.reset();
+        crd.running = false;
+        release_crd_axes(card, crd);
+    }
+    if (!a.moving) return ERR_OK;
+    Clock::time_point now = Clock::now();
+    double v = axis_velocity(a, now);
+    a.moving = false;
+    a.motion.track.reset();
+    a.stop_reason = stop_mode ? 2 : 1;
+    if (stop_mode == 0 && std::fabs(v) > SIM_EPS) {
+        double dec = a.profile.tdec > SIM_EPS ? a.profile.max_vel / a.profile.tdec : 1e12;
+        start_motion(a, std::make_shared<DecelTrack>(v, dec), v > 0 ? 1.0 : -1.0, now);
+        a.stop_reason = 1;
+    }
+    return ERR_OK;
+}
+
+short smc_emg_stop(WORD ConnectNo) {
+    SIM_ENTER(ConnectNo);
+    for (CrdState &crd : card.crds) {
+        crd.queue.clear();
+        crd.track.reset();
+        crd.running = false;
+        release_crd_axes(card, crd);
+    }
+    for (Axis &a : card.axes) {
+        if (a.moving) a.stop_reason = 3;
+        a.moving = false;
+        a.motion.track.reset();
+    }
+    card.script.gcode_state = 0;
+    return ERR_OK;
+}
+
+short smc_clear_stop_reason(WORD ConnectNo, WORD axis) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    card.axes[axis].stop_reason = 0;
+    return ERR_OK;
+}
+
+short smc_check_done(WORD ConnectNo, WORD axis) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    return axis_busy(card, axis) ? 0 : 1;
+}
+
+short smc_get_position_unit(WORD ConnectNo, WORD axis, double *pos) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    if (pos) *pos = card.axes[axis].pos;
+    return ERR_OK;
+}
+
+short smc_set_encoder_unit(WORD ConnectNo, WORD axis, double pos) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    Axis &a = card.axes[axis];
+    a.motion.start += pos - a.pos;
+    a.pos = pos;
+    return ERR_OK;
+}
+
+// ---------- PVT ----------
+short smc_pvt_table_unit(WORD ConnectNo, WORD iaxis, DWORD count, double *pTime, double *pPos, double *pVel) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(iaxis);
+    if (count < 2 || !pTime || !pPos || !pVel) return ERR_PARAM;
+    auto table = std::make_shared<PvtTrack>();
+    table->time.assign(pTime, pTime + count);
+    table->pos.assign(pPos, pPos + count);
+    table->vel.assign(pVel, pVel + count);
+    for (DWORD i = 1; i < count; ++i) {
+        if (table->time[i] < table->time[i - 1]) return ERR_PARAM;
+    }
+    card.pvt_tables[iaxis] = table;
+    return ERR_OK;
+}
+
+short smc_pvt_move(WORD ConnectNo, WORD AxisNum, WORD *AxisList) {
+    SIM_ENTER(ConnectNo);
+    if (AxisNum == 0 || !AxisList) return ERR_PARAM;
+    for (WORD i = 0; i < AxisNum; ++i) {
+        SIM_CHECK_AXIS(AxisList[i]);
+        if (axis_busy(card, AxisList[i])) return ERR_BUSY;
+        if (!card.pvt_tables.count(AxisList[i])) return ERR_PARAM;
+    }
+    Clock::time_point now = Clock::now();
+    for (WORD i = 0; i < AxisNum; ++i) {
+        start_motion(card.axes[AxisList[i]], card.pvt_tables[AxisList[i]], 1.0, now);
+    }
+    return ERR_OK;
+}
+
+// ---------- 连续插补 ----------
+short smc_conti_set_lookahead_mode(WORD ConnectNo, WORD Crd, WORD enable, long, double, double) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS) return ERR_PARAM;
+    card.crds[Crd].lookahead = enable != 0;
+    return ERR_OK;
+}
+
+short smc_conti_set_blend(WORD ConnectNo, WORD Crd, WORD enable) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS) return ERR_PARAM;
+    card.crds[Crd].blend = enable != 0;
+    return ERR_OK;
+}
+
+short smc_conti_open_list(WORD ConnectNo, WORD Crd, WORD AxisNum, WORD *AxisList) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS || AxisNum == 0 || !AxisList) return ERR_PARAM;
+    CrdState &crd = card.crds[Crd];
+    if (crd.running && (crd.track || !crd.queue.empty())) return ERR_BUSY;
+    for (WORD i = 0; i < AxisNum; ++i) {
+        SIM_CHECK_AXIS(AxisList[i]);
+        if (axis_busy(card, AxisList[i])) return ERR_BUSY;
+    }
+    release_crd_axes(card, crd);
+    crd.open = true;
+    crd.closed = false;
+    crd.running = false;
+    crd.paused = false;
+    crd.queue.clear();
+    crd.track.reset();
+    crd.current_mark = 0;
+    crd.axes.assign(AxisList, AxisList + AxisNum);
+    for (WORD a : crd.axes) card.axes[a].crd = Crd;
+    return ERR_OK;
+}
+
+short smc_conti_close_list(WORD ConnectNo, WORD Crd) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS) return ERR_PARAM;
+    CrdState &crd = card.crds[Crd];
+    crd.open = false;
+    crd.closed = true;
+    if (!crd.running) release_crd_axes(card, crd);
+    return ERR_OK;
+}
+
+short smc_conti_start_list(WORD ConnectNo, WORD Crd) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS) return ERR_PARAM;
+    CrdState &crd = card.crds[Crd];
+    crd.running = true;
+    crd.paused = false;
+    return ERR_OK;
+}
+
+short smc_conti_pause_list(WORD ConnectNo, WORD Crd) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS) return ERR_PARAM;
+    card.crds[Crd].paused = true;
+    return ERR_OK;
+}
+
+// 仿真中减速停止与立即停止均在当前位置停住
+short smc_conti_stop_list(WORD ConnectNo, WORD Crd, WORD) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS) return ERR_PARAM;
+    CrdState &crd = card.crds[Crd];
+    crd.queue.clear();
+    crd.track.reset();
+    crd.running = false;
+    crd.paused = false;
+    crd.open = false;
+    release_crd_axes(card, crd);
+    return ERR_OK;
+}
+
+short smc_conti_set_override(WORD ConnectNo, WORD Crd, double Percent) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS || Percent < 0) return ERR_PARAM;
+    card.crds[Crd].override_ratio = Percent / 100.0;
+    return ERR_OK;
+}
+
+// 仿真约定：0=运行, 1=暂停, 2=停止
+short smc_conti_get_run_state(WORD ConnectNo, WORD Crd) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS) return ERR_PARAM;
+    const CrdState &crd = card.crds[Crd];
+    if (!crd.running) return 2;
+    return crd.paused ? 1 : 0;
+}
+
+long smc_conti_remain_space(WORD ConnectNo, WORD Crd) {
+    SIM_ENTER_OR(ConnectNo, 0);
+    if (Crd >= SIM_CRDS) return 0;
+    return std::max(0L, g_config.conti_space - static_cast<long>(card.crds[Crd].queue.size()));
+}
+
+long smc_conti_read_current_mark(WORD ConnectNo, WORD Crd) {
+    SIM_ENTER_OR(ConnectNo, 0);
+    if (Crd >= SIM_CRDS) return 0;
+    return card.crds[Crd].current_mark;
+}
+
+namespace {
+short push_segment(Card &card, WORD crd_no, ContiSegment seg) {
+    if (crd_no >= SIM_CRDS) return ERR_PARAM;
+    CrdState &crd = card.crds[crd_no];
+    if (!crd.open) return ERR_UNKNOWN;
+    if (static_cast<long>(crd.queue.size()) >= g_config.conti_space) return ERR_BUSY;
+    seg.profile = crd.vector_profile;
+    crd.queue.push_back(seg);
+    return ERR_OK;
+}
+
+// 段目标按坐标系轴序重排，未列出的轴保持不动
+ContiSegment line_segment(const CrdState &crd, WORD AxisNum, const WORD *AxisList, const double *pos, WORD posi_mode, long mark) {
+    ContiSegment seg;
+    seg.absolute = posi_mode != 0;
+    seg.mark = mark;
+    seg.target.assign(crd.axes.size(), seg.absolute ? std::numeric_limits<double>::quiet_NaN() : 0.0);
+    for (WORD i = 0; i < AxisNum; ++i) {
+        auto it = std::find(crd.axes.begin(), crd.axes.end(), AxisList[i]);
+        if (it != crd.axes.end()) seg.target[it - crd.axes.begin()] = pos[i];
+    }
+    return seg;
+}
+}  // namespace
+
+short smc_conti_line_unit(WORD ConnectNo, WORD Crd, WORD AxisNum, WORD *AxisList, double *pPosList, WORD posi_mode, long mark) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS || !AxisList || !pPosList) return ERR_PARAM;
+    return push_segment(card, Crd, line_segment(card.crds[Crd], AxisNum, AxisList, pPosList, posi_mode, mark));
+}
+
+// 圆弧段在仿真中按弦线（直线到终点）执行，用于计时与缓冲区行为
+short smc_conti_arc_move_center_unit(WORD ConnectNo, WORD Crd, WORD AxisNum, WORD *AxisList, double *Target_Pos, double *,
+                                     WORD, long, WORD posi_mode, long mark) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS || !AxisList || !Target_Pos) return ERR_PARAM;
+    return push_segment(card, Crd, line_segment(card.crds[Crd], AxisNum, AxisList, Target_Pos, posi_mode, mark));
+}
+
+short smc_conti_arc_move_radius_unit(WORD ConnectNo, WORD Crd, WORD AxisNum, WORD *AxisList, double *Target_Pos, double,
+                                     WORD, long, WORD posi_mode, long mark) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS || !AxisList || !Target_Pos) return ERR_PARAM;
+    return push_segment(card, Crd, line_segment(card.crds[Crd], AxisNum, AxisList, Target_Pos, posi_mode, mark));
+}
+
+short smc_conti_arc_move_3points_unit(WORD ConnectNo, WORD Crd, WORD AxisNum, WORD *AxisList, double *Target_Pos, double *,
+                                      long, WORD posi_mode, long mark) {
+    SIM_ENTER(ConnectNo);
+    if (Crd >= SIM_CRDS || !AxisList || !Target_Pos) return ERR_PARAM;
+    return push_segment(card, Crd, line_segment(card.crds[Crd], AxisNum, AxisList, Target_Pos, posi_mode, mark));
+}
+
+short smc_conti_delay(WORD ConnectNo, WORD Crd, double delay_time, long mark) {
+    SIM_ENTER(ConnectNo);
+    ContiSegment seg;
+    seg.delay = true;
+    seg.delay_time = delay_time;
+    seg.mark = mark;
+    return push_segment(card, Crd, seg);
+}
+
+// ---------- IO ----------
+DWORD smc_axis_io_status(WORD ConnectNo, WORD axis) {
+    SIM_ENTER_OR(ConnectNo, 0);
+    if (axis >= SIM_AXES) return 0;
+    return 0;   // 无报警、急停、限位
+}
+
+short smc_read_org_pin(WORD ConnectNo, WORD axis) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    const Axis &a = card.axes[axis];
+    return (!axis_busy(card, axis) && std::fabs(a.pos) < 1e-6) ? 0 : 1;   // 低电平有效
+}
+
+short smc_read_org_pin_ex(WORD ConnectNo, WORD uiaxis, WORD *state) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(uiaxis);
+    const Axis &a = card.axes[uiaxis];
+    if (state) *state = (!axis_busy(card, uiaxis) && std::fabs(a.pos) < 1e-6) ? 0 : 1;
+    return ERR_OK;
+}
+
+short smc_read_elp_pin(WORD ConnectNo, WORD axis) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    return 1;
+}
+
+short smc_read_eln_pin(WORD ConnectNo, WORD axis) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    return 1;
+}
+
+short smc_read_sevon_pin(WORD ConnectNo, WORD axis) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    return static_cast<short>(card.axes[axis].servo_level);
+}
+
+short smc_read_sevon_pin_ex(WORD ConnectNo, WORD axis, WORD *state) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    if (state) *state = card.axes[axis].servo_level;
+    return ERR_OK;
+}
+
+short smc_write_sevon_pin(WORD ConnectNo, WORD axis, WORD on_off) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    card.axes[axis].servo_level = on_off ? 1 : 0;
+    return ERR_OK;
+}
+
+short smc_write_outbit(WORD ConnectNo, WORD bitno, WORD on_off) {
+    SIM_ENTER(ConnectNo);
+    if (bitno >= SIM_OUT_BITS) return ERR_PARAM;
+    card.out_bits[bitno] = on_off ? 1 : 0;
+    return ERR_OK;
+}
+
+short smc_read_outbit(WORD ConnectNo, WORD bitno) {
+    SIM_ENTER(ConnectNo);
+    if (bitno >= SIM_OUT_BITS) return ERR_PARAM;
+    return static_cast<short>(card.out_bits[bitno]);
+}
+
+DWORD smc_read_inport(WORD ConnectNo, WORD portno) {
+    SIM_ENTER_OR(ConnectNo, 0xFFFFFFFFUL);
+    if (portno >= SIM_IO_PORTS) return 0;
+    return 0xFFFFFFFFUL;   // 输入低电平有效，全部无效
+}
+
+short smc_read_inport_ex(WORD ConnectNo, WORD portno, DWORD *state) {
+    SIM_ENTER(ConnectNo);
+    if (portno >= SIM_IO_PORTS) return ERR_PARAM;
+    if (state) *state = 0xFFFFFFFFUL;
+    return ERR_OK;
+}
+
+short smc_set_da_output(WORD ConnectNo, WORD channel, double Vout) {
+    SIM_ENTER(ConnectNo);
+    if (channel >= SIM_AD_CHANNELS) return ERR_PARAM;
+    card.da_output[channel] = Vout;
+    return ERR_OK;
+}
+
+double smc_get_ain(WORD ConnectNo, WORD channel) {
+    SIM_ENTER_OR(ConnectNo, 0.0);
+    if (channel >= SIM_AD_CHANNELS) return 0.0;
+    return card.da_output[channel];   // 模拟量输出回环到同号输入
+}
+
+// ---------- 位置比较 ----------
+short smc_hcmp_set_mode(WORD ConnectNo, WORD hcmp, WORD cmp_mode) {
+    SIM_ENTER(ConnectNo);
+    if (hcmp >= SIM_HCMPS) return ERR_PARAM;
+    card.hcmps[hcmp].mode = cmp_mode;
+    return ERR_OK;
+}
+
+short smc_hcmp_set_config(WORD ConnectNo, WORD hcmp, WORD axis, WORD, WORD, long) {
+    SIM_ENTER(ConnectNo);
+    if (hcmp >= SIM_HCMPS) return ERR_PARAM;
+    SIM_CHECK_AXIS(axis);
+    card.hcmps[hcmp].axis = axis;
+    return ERR_OK;
+}
+
+short smc_hcmp_add_point_unit(WORD ConnectNo, WORD hcmp, double cmp_pos) {
+    SIM_ENTER(ConnectNo);
+    if (hcmp >= SIM_HCMPS) return ERR_PARAM;
+    card.hcmps[hcmp].points.push_back(cmp_pos);
+    return ERR_OK;
+}
+
+short smc_hcmp_set_liner_unit(WORD ConnectNo, WORD hcmp, double Increment, long Count) {
+    SIM_ENTER(ConnectNo);
+    if (hcmp >= SIM_HCMPS) return ERR_PARAM;
+    card.hcmps[hcmp].liner_inc = Increment;
+    card.hcmps[hcmp].liner_count = Count;
+    return ERR_OK;
+}
+
+short smc_hcmp_clear_points(WORD ConnectNo, WORD hcmp) {
+    SIM_ENTER(ConnectNo);
+    if (hcmp >= SIM_HCMPS) return ERR_PARAM;
+    Hcmp &cmp = card.hcmps[hcmp];
+    cmp.points.clear();
+    cmp.liner_count = 0;
+    cmp.runned = 0;
+    return ERR_OK;
+}
+
+short smc_hcmp_get_current_state_unit(WORD ConnectNo, WORD hcmp, long *remained_points, double *current_point, long *runned_points) {
+    SIM_ENTER(ConnectNo);
+    if (hcmp >= SIM_HCMPS) return ERR_PARAM;
+    const Hcmp &cmp = card.hcmps[hcmp];
+    long remained = static_cast<long>(cmp.points.size());
+    if (cmp.liner_count > 1 && !cmp.points.empty()) remained += cmp.liner_count - 1;
+    if (remained_points) *remained_points = remained;
+    if (current_point) *current_point = cmp.points.empty() ? cmp.current : cmp.points.front();
+    if (runned_points) *runned_points = cmp.runned;
+    return ERR_OK;
+}
+
+// ---------- 锁存 ----------
+short smc_set_ltc_mode(WORD ConnectNo, WORD axis, WORD, WORD, double) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    return ERR_OK;
+}
+
+short smc_set_latch_mode(WORD ConnectNo, WORD axis, WORD all_enable, WORD, WORD) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    card.axes[axis].latch_enabled = all_enable != 0;
+    card.axes[axis].latch_flag = false;
+    card.axes[axis].latch_trigger = Clock::now() + std::chrono::milliseconds(g_config.latch_period_ms);
+    return ERR_OK;
+}
+
+short smc_get_latch_flag(WORD ConnectNo, WORD axis) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    return card.axes[axis].latch_flag ? 1 : 0;
+}
+
+short smc_reset_latch_flag(WORD ConnectNo, WORD axis) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    card.axes[axis].latch_flag = false;
+    card.axes[axis].latch_trigger = Clock::now() + std::chrono::milliseconds(g_config.latch_period_ms);
+    return ERR_OK;
+}
+
+short smc_get_latch_value_unit(WORD ConnectNo, WORD axis, double *pos_by_mm) {
+    SIM_ENTER(ConnectNo);
+    SIM_CHECK_AXIS(axis);
+    if (pos_by_mm) *pos_by_mm = card.axes[axis].latch_value;
+    return ERR_OK;
+}
+
+short smc_ltc_set_mode(WORD ConnectNo, WORD latch, WORD ltc_mode, WORD, double) {
+    SIM_ENTER(ConnectNo);
+    if (latch >= SIM_LATCHES) return ERR_PARAM;
+    card.latches[latch].mode = ltc_mode;
+    return ERR_OK;
+}
+
+short smc_ltc_set_source(WORD ConnectNo, WORD latch, WORD axis, WORD) {
+    SIM_ENTER(ConnectNo);
+    if (latch >= SIM_LATCHES) return ERR_PARAM;
+    SIM_CHECK_AXIS(axis);
+    Latch &l = card.latches[latch];
+    if (std::find(l.axes.begin(), l.axes.end(), axis) == l.axes.end()) l.axes.push_back(axis);
+    return ERR_OK;
+}
+
+short smc_ltc_reset(WORD ConnectNo, WORD latch) {
+    SIM_ENTER(ConnectNo);
+    if (latch >= SIM_LATCHES) return ERR_PARAM;
+    Latch &l = card.latches[latch];
+    l.values.clear();
+    l.armed = true;
+    l.next_trigger = Clock::now() + std::chrono::milliseconds(g_config.latch_period_ms);
+    return ERR_OK;
+}
+
+short smc_ltc_get_number(WORD ConnectNo, WORD latch, WORD axis, int *number) {
+    SIM_ENTER(ConnectNo);
+    if (latch >= SIM_LATCHES) return ERR_PARAM;
+    SIM_CHECK_AXIS(axis);
+    auto it = card.latches[latch].values.find(axis);
+    if (number) *number = it == card.latches[latch].values.end() ? 0 : static_cast<int>(it->second.size());
+    return ERR_OK;
+}
+
+short smc_ltc_get_value_unit(WORD ConnectNo, WORD latch, WORD axis, double *value) {
+    SIM_ENTER(ConnectNo);
+    if (latch >= SIM_LATCHES) return ERR_PARAM;
+    SIM_CHECK_AXIS(axis);
+    std::deque<double> &fifo = card.latches[latch].values[axis];
+    if (fifo.empty()) return ERR_UNKNOWN;
+    if (value) *value = fifo.front();
+    fifo.pop_front();
+    return ERR_OK;
+}
+
+// ---------- 文件与程序 ----------
+short smc_download_memfile(WORD ConnectNo, const char *pbuffer, uint32 buffsize, const char *pfilenameinControl, WORD) {
+    SIM_ENTER(ConnectNo);
+    if (!pbuffer || !pfilenameinControl) return ERR_PARAM;
+    card.script.files[pfilenameinControl] = std::string(pbuffer, buffsize);
+    return ERR_OK;
+}
+
+short smc_basic_run(WORD ConnectNo) {
+    SIM_ENTER(ConnectNo);
+    card.script.basic_messages += "BASIC engine is not simulated, program ignored\n";
+    card.script.basic_state = 0;
+    return ERR_OK;
+}
+
+short smc_basic_stop(WORD ConnectNo) {
+    SIM_ENTER(ConnectNo);
+    card.script.basic_state = 0;
+    return ERR_OK;
+}
+
+short smc_basic_pause(WORD ConnectNo) {
+    SIM_ENTER(ConnectNo);
+    return ERR_OK;
+}
+
+short smc_basic_continue_run(WORD ConnectNo) {
+    SIM_ENTER(ConnectNo);
+    return ERR_OK;
+}
+
+short smc_basic_state(WORD ConnectNo, WORD *State) {
+    SIM_ENTER(ConnectNo);
+    if (State) *State = card.script.basic_state;
+    return ERR_OK;
+}
+
+short smc_basic_current_line(WORD ConnectNo, uint32 *line) {
+    SIM_ENTER(ConnectNo);
+    if (line) *line = 0;
+    return ERR_OK;
+}
+
+short smc_basic_message(WORD ConnectNo, char *pbuff, uint32 uimax, uint32 *puiread) {
+    SIM_ENTER(ConnectNo);
+    uint32 n = std::min<uint32>(uimax, static_cast<uint32>(card.script.basic_messages.size()));
+    if (pbuff && n > 0) std::memcpy(pbuff, card.script.basic_messages.data(), n);
+    card.script.basic_messages.erase(0, n);
+    if (puiread) *puiread = n;
+    return ERR_OK;
+}
+
+short smc_gcode_set_current_file(WORD ConnectNo, const char *pFileName) {
+    SIM_ENTER(ConnectNo);
+    if (!pFileName || !card.script.files.count(pFileName)) return ERR_PARAM;
+    card.script.gcode_file = pFileName;
+    card.script.gcode_state = 0;
+    return ERR_OK;
+}
+
+short smc_gcode_start(WORD ConnectNo) {
+    SIM_ENTER(ConnectNo);
+    ScriptEngine &script = card.script;
+    CrdState &crd = card.crds[SIM_CRDS];
+    if (script.gcode_state == 2) {
+        crd.paused = false;
+        script.gcode_state = 1;
+        return ERR_OK;
+    }
+    if (script.gcode_file.empty()) return ERR_UNKNOWN;
+    for (WORD a = 0; a < 6; ++a) {
+        if (axis_busy(card, a)) return ERR_BUSY;
+    }
+    load_gcode(card, script.files[script.gcode_file]);
+    for (WORD a : crd.axes) card.axes[a].crd = SIM_CRDS;
+    crd.running = true;
+    script.gcode_state = 1;
+    return ERR_OK;
+}
+
+short smc_gcode_pause(WORD ConnectNo) {
+    SIM_ENTER(ConnectNo);
+    if (card.script.gcode_state == 1) {
+        card.crds[SIM_CRDS].paused = true;
+        card.script.gcode_state = 2;
+    }
+    return ERR_OK;
+}
+
+short smc_gcode_stop(WORD ConnectNo) {
+    SIM_ENTER(ConnectNo);
+    CrdState &crd = card.crds[SIM_CRDS];
+    crd.queue.clear();
+    crd.track.reset();
+    crd.running = false;
+    release_crd_axes(card, crd);
+    card.script.gcode_state = 0;
+    return ERR_OK;
+}
+
+short smc_gcode_state(WORD ConnectNo, WORD *State) {
+    SIM_ENTER(ConnectNo);
+    if (State) *State = card.script.gcode_state;
+    return ERR_OK;
+}
+
+short smc_gcode_get_current_line(WORD ConnectNo, uint32 *line, char *pCurLine) {
+    SIM_ENTER(ConnectNo);
+    long mark = card.crds[SIM_CRDS].current_mark;
+    if (line) *line = static_cast<uint32>(mark);
+    if (pCurLine) {
+        pCurLine[0] = '\0';
+        if (mark > 0 && static_cast<size_t>(mark) <= card.script.gcode_lines.size()) {
+            std::strncpy(pCurLine, card.script.gcode_lines[mark - 1].c_str(), 255);
+            pCurLine[255] = '\0';
+        }
+    }
+    return ERR_OK;
+}
+
+short smc_gcode_stop_reason(WORD ConnectNo, WORD *stop_reason) {
+    SIM_ENTER(ConnectNo);
+    if (stop_reason) *stop_reason = 0;
+    return ERR_OK;
+}
+
+}  // extern "C"